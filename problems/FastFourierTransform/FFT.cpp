@@ -25,10 +25,10 @@ void fft(vector<Complex>& a, vector<Complex>& out, int start, int n, int step) {
     vector<Complex> even(half), odd(half);
 
     if (n > 2048) {
-        #pragma omp task shared(a)
+        #pragma omp task shared(a, even, odd)
         fft(a, even, start, half, 2 * step);
 
-        #pragma omp task shared(a)
+        #pragma omp task shared(a, even, odd)
         fft(a, odd, start + step, half, 2 * step);
 
         #pragma omp taskwait
@@ -52,8 +52,6 @@ int main() {
     vector<Complex> input(n, 1); // All values set to 1
     vector<Complex> output(n);
 
-    omp_set_num_threads(4); // Set number of threads
-
     auto start_time = chrono::high_resolution_clock::now();
 
     #pragma omp parallel
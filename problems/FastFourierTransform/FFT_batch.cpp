@@ -0,0 +1,92 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <omp.h>
+#include "FFT_batch.h"
+#include "FFT_plan.h"
+#include "FFT_reference.h"
+
+// Many medium-size transforms: B signals of length n, with
+//   - FFT.cpp's approach: one signal at a time, OpenMP tasks inside it
+//   - one FftPlan, signals spread over the threads (no interleaving)
+//   - BatchFFT across the batch (lane-interleaved), within each transform, and
+//     the mode it picks by itself
+// Every result is compared with IterativeFFT applied to each signal.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+double maxError(const vector<Complex>& x, const vector<Complex>& reference) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        err = max(err, abs(x[i] - reference[i]));
+        scale = max(scale, abs(reference[i]));
+    }
+    return err / scale;
+}
+
+// Usage: ./cpp_FFT_batch [log2n] [batch]
+int main(int argc, char* argv[]) {
+    int n = 1 << (argc > 1 ? stoi(argv[1]) : 10);
+    int batch = argc > 2 ? stoi(argv[2]) : 4096;
+
+    vector<Complex> input(static_cast<size_t>(n) * batch);
+    mt19937_64 gen(42);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (auto& x : input) x = Complex(dist(gen), dist(gen));
+
+    vector<Complex> reference = input;
+    IterativeFFT<double> single(n);
+    for (int b = 0; b < batch; ++b) single(reference.data() + static_cast<size_t>(b) * n);
+
+    BatchFFT<double> batched(n, batch);
+    cout << batch << " signals of " << n << " points, " << omp_get_max_threads() << " thread(s), "
+         << isaName(batched.isa()) << " (" << batched.lanes() << " signals per group)\n";
+
+    auto report = [&](const string& name, double seconds, const vector<Complex>& result) {
+        cout << name << seconds << " seconds (" << batch / seconds << " transforms/s), max error "
+             << maxError(result, reference) << "\n";
+    };
+
+    {
+        vector<Complex> out(input.size()), signal(n), spectrum(n);
+        double t0 = omp_get_wtime();
+        #pragma omp parallel
+        {
+            #pragma omp single
+            for (int b = 0; b < batch; ++b) {
+                copy(input.begin() + static_cast<size_t>(b) * n, input.begin() + static_cast<size_t>(b + 1) * n,
+                     signal.begin());
+                fftRecursiveTasks(signal, spectrum, 0, n, 1);
+                copy(spectrum.begin(), spectrum.end(), out.begin() + static_cast<size_t>(b) * n);
+            }
+        }
+        report("FFT.cpp tasks per signal     : ", omp_get_wtime() - t0, out);
+    }
+    {
+        FftPlan<double> plan(n);
+        vector<Complex> out(input.size());
+        double t0 = omp_get_wtime();
+        #pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < batch; ++b) {
+            plan.execute(input.data() + static_cast<size_t>(b) * n, out.data() + static_cast<size_t>(b) * n);
+        }
+        report("FftPlan, signals over threads: ", omp_get_wtime() - t0, out);
+    }
+    for (BatchMode mode : {BatchMode::AcrossBatch, BatchMode::WithinTransform, BatchMode::Auto}) {
+        vector<Complex> data = input;
+        double t0 = omp_get_wtime();
+        batched.execute(data.data(), mode);
+        double t = omp_get_wtime() - t0;
+        string name = string("BatchFFT ") + batchModeName(mode);
+        if (mode == BatchMode::Auto) name += string(" (") + batchModeName(batched.choose()) + ")";
+        if (name.size() < 29) name.resize(29, ' ');
+        report(name + ": ", t, data);
+    }
+
+    return 0;
+}
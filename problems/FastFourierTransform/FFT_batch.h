@@ -0,0 +1,274 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <omp.h>
+#include "FFT_simd.h"
+
+// Batched FFT: B signals of length n with the same plan.
+//
+// Two ways to use the threads:
+//   AcrossBatch      each thread transforms whole signals. W signals at a time
+//                    are interleaved lane by lane (sample i of signal l at
+//                    i * W + l, separate re/im arrays), so one vector register
+//                    holds the same sample of W signals and every butterfly,
+//                    including the short first passes, runs on full registers
+//                    with one broadcast twiddle.
+//   WithinTransform  the signals are done one after another and every pass of a
+//                    transform is shared by the threads (SplitFFT::parallel).
+// Auto picks AcrossBatch when there are at least as many groups of W signals as
+// threads, or when the transforms are too small to be worth splitting, and
+// WithinTransform otherwise (a few large signals). The thread count is the
+// OpenMP default (OMP_NUM_THREADS), not a fixed number.
+
+enum class BatchMode { Auto, AcrossBatch, WithinTransform };
+
+inline const char* batchModeName(BatchMode mode) {
+    switch (mode) {
+        case BatchMode::AcrossBatch: return "across batch";
+        case BatchMode::WithinTransform: return "within transform";
+        default: return "auto";
+    }
+}
+
+namespace batch_detail {
+
+// Full transform of W interleaved signals; tables as in SplitFFT
+template <typename T, int W>
+__attribute__((always_inline)) inline void laneTransform(T* re, T* im, size_t n, const uint32_t* bitrev,
+                                                         bool radix2First, const T* tw, int direction) {
+    typedef typename simd_detail::VecType<T, W>::type V;
+    V* xr = reinterpret_cast<V*>(re);
+    V* xi = reinterpret_cast<V*>(im);
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t r = bitrev[i];
+        if (i < r) {
+            V tr = xr[i], ti = xi[i];
+            xr[i] = xr[r];
+            xi[i] = xi[r];
+            xr[r] = tr;
+            xi[r] = ti;
+        }
+    }
+    if (radix2First) {
+        for (size_t i = 0; i < n; i += 2) {
+            V ar = xr[i], ai = xi[i];
+            xr[i] = ar + xr[i + 1];
+            xi[i] = ai + xi[i + 1];
+            xr[i + 1] = ar - xr[i + 1];
+            xi[i + 1] = ai - xi[i + 1];
+        }
+    }
+
+    for (size_t m = radix2First ? 2 : 1; 4 * m <= n; m *= 4) {
+        for (size_t base = 0; base < n; base += 4 * m) {
+            V* yr = xr + base;
+            V* yi = xi + base;
+            for (size_t k = 0; k < m; ++k) {
+                T w1r = tw[k], w1i = tw[m + k];
+                T w2r = tw[2 * m + k], w2i = tw[3 * m + k];
+                T w3r = tw[4 * m + k], w3i = tw[5 * m + k];
+
+                V ar = yr[k], ai = yi[k];
+                V q1r = yr[k + m], q1i = yi[k + m];
+                V q2r = yr[k + 2 * m], q2i = yi[k + 2 * m];
+                V q3r = yr[k + 3 * m], q3i = yi[k + 3 * m];
+
+                V br = q1r * w2r - q1i * w2i, bi = q1r * w2i + q1i * w2r;
+                V cr = q2r * w1r - q2i * w1i, ci = q2r * w1i + q2i * w1r;
+                V dr = q3r * w3r - q3i * w3i, di = q3r * w3i + q3i * w3r;
+
+                V t0r = ar + br, t0i = ai + bi;
+                V t1r = ar - br, t1i = ai - bi;
+                V t2r = cr + dr, t2i = ci + di;
+                V t3r = direction < 0 ? ci - di : di - ci;
+                V t3i = direction < 0 ? dr - cr : cr - dr;
+
+                yr[k] = t0r + t2r;
+                yi[k] = t0i + t2i;
+                yr[k + m] = t1r + t3r;
+                yi[k + m] = t1i + t3i;
+                yr[k + 2 * m] = t0r - t2r;
+                yi[k + 2 * m] = t0i - t2i;
+                yr[k + 3 * m] = t1r - t3r;
+                yi[k + 3 * m] = t1i - t3i;
+            }
+        }
+        tw += 6 * m;
+    }
+}
+
+template <typename T>
+void laneScalar(T* re, T* im, size_t n, const uint32_t* bitrev, bool radix2First, const T* tw, int direction) {
+    laneTransform<T, 1>(re, im, n, bitrev, radix2First, tw, direction);
+}
+
+__attribute__((target("avx2,fma"))) inline void laneAvx2(double* re, double* im, size_t n, const uint32_t* bitrev,
+                                                         bool radix2First, const double* tw, int direction) {
+    laneTransform<double, 4>(re, im, n, bitrev, radix2First, tw, direction);
+}
+
+__attribute__((target("avx2,fma"))) inline void laneAvx2(float* re, float* im, size_t n, const uint32_t* bitrev,
+                                                         bool radix2First, const float* tw, int direction) {
+    laneTransform<float, 8>(re, im, n, bitrev, radix2First, tw, direction);
+}
+
+__attribute__((target("avx512f"))) inline void laneAvx512(double* re, double* im, size_t n, const uint32_t* bitrev,
+                                                           bool radix2First, const double* tw, int direction) {
+    laneTransform<double, 8>(re, im, n, bitrev, radix2First, tw, direction);
+}
+
+__attribute__((target("avx512f"))) inline void laneAvx512(float* re, float* im, size_t n, const uint32_t* bitrev,
+                                                           bool radix2First, const float* tw, int direction) {
+    laneTransform<float, 16>(re, im, n, bitrev, radix2First, tw, direction);
+}
+
+}  // namespace batch_detail
+
+template <typename T>
+class BatchFFT {
+public:
+    using Complex = std::complex<T>;
+
+    BatchFFT(size_t n, size_t batch, int direction = -1, SimdIsa isa = detectIsa())
+        : n_(n), batch_(batch), split_(n, direction, isa) {
+        size_t bytes = split_.isa() == SimdIsa::Avx512 ? 64 : split_.isa() == SimdIsa::Avx2 ? 32 : sizeof(T);
+        lanes_ = bytes / sizeof(T);
+    }
+
+    size_t size() const { return n_; }
+    size_t batch() const { return batch_; }
+    SimdIsa isa() const { return split_.isa(); }
+    // Signals per interleaved group
+    size_t lanes() const { return lanes_; }
+    size_t groups() const { return groups(batch_); }
+    size_t groups(size_t count) const { return (count + lanes_ - 1) / lanes_; }
+
+    BatchMode choose() const { return choose(batch_); }
+    BatchMode choose(size_t count) const {
+        size_t threads = omp_get_max_threads();
+        return groups(count) >= threads || n_ < (size_t(1) << 14) ? BatchMode::AcrossBatch : BatchMode::WithinTransform;
+    }
+
+    // signals[b * n + i], b < batch, transformed in place
+    void execute(Complex* signals, BatchMode mode = BatchMode::Auto) const { execute(signals, batch_, mode); }
+
+    // Same with another batch size than the one given at construction
+    void execute(Complex* signals, size_t count, BatchMode mode) const {
+        if (mode == BatchMode::Auto) mode = choose(count);
+        if (mode == BatchMode::WithinTransform) {
+            std::vector<T> re(n_), im(n_);
+            for (size_t b = 0; b < count; ++b) {
+                Complex* x = signals + b * n_;
+                #pragma omp parallel for schedule(static)
+                for (size_t i = 0; i < n_; ++i) re[i] = x[i].real(), im[i] = x[i].imag();
+                split_.parallel(re.data(), im.data());
+                #pragma omp parallel for schedule(static)
+                for (size_t i = 0; i < n_; ++i) x[i] = Complex(re[i], im[i]);
+            }
+            return;
+        }
+
+        #pragma omp parallel
+        {
+            std::vector<T> re(n_ * lanes_), im(n_ * lanes_);
+            #pragma omp for schedule(dynamic)
+            for (size_t g = 0; g < groups(count); ++g) {
+                size_t first = g * lanes_, used = std::min(lanes_, count - first);
+                std::fill(re.begin(), re.end(), T(0));
+                std::fill(im.begin(), im.end(), T(0));
+                for (size_t l = 0; l < used; ++l) {
+                    const Complex* x = signals + (first + l) * n_;
+                    for (size_t i = 0; i < n_; ++i) {
+                        re[i * lanes_ + l] = x[i].real();
+                        im[i * lanes_ + l] = x[i].imag();
+                    }
+                }
+                transformGroup(re.data(), im.data());
+                for (size_t l = 0; l < used; ++l) {
+                    Complex* x = signals + (first + l) * n_;
+                    for (size_t i = 0; i < n_; ++i) x[i] = Complex(re[i * lanes_ + l], im[i * lanes_ + l]);
+                }
+            }
+        }
+    }
+
+    // Data already in the interleaved layout: group g holds re/im[g * n * lanes() ..
+    // (g + 1) * n * lanes()), sample i of its signal l at i * lanes() + l
+    void executeInterleaved(T* re, T* im, size_t groupCount) const {
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t g = 0; g < groupCount; ++g) transformGroup(re + g * n_ * lanes_, im + g * n_ * lanes_);
+    }
+
+    // One interleaved group of lanes() signals (n * lanes() values in re and in
+    // im), on the calling thread
+    void transformGroup(T* re, T* im) const {
+        const uint32_t* bitrev = split_.bitReversal();
+        const T* tw = split_.twiddles();
+        int dir = split_.direction();
+        switch (split_.isa()) {
+            case SimdIsa::Avx512: batch_detail::laneAvx512(re, im, n_, bitrev, split_.radix2First(), tw, dir); break;
+            case SimdIsa::Avx2: batch_detail::laneAvx2(re, im, n_, bitrev, split_.radix2First(), tw, dir); break;
+            default: batch_detail::laneScalar(re, im, n_, bitrev, split_.radix2First(), tw, dir); break;
+        }
+    }
+
+private:
+    size_t n_, batch_, lanes_;
+    SplitFFT<T> split_;
+};
+
+// FFTs of length fft.size() down each of the ncols columns of a matrix with
+// that many rows, a block of adjacent columns at a time: every row contributes
+// one short contiguous strip, the strips are gathered into lane-interleaved
+// buffers that fit in cache, and the column transforms of a block run on SIMD
+// lanes side by side. rowStrip(i, c) points at element (i, c) and must be
+// contiguous for the block starting at c; store(c, k, v) receives output k of
+// column c, so a transpose can be folded into the scatter. ncols need not be
+// a multiple of width; the last block is then narrower. One parallel loop over
+// blocks.
+template <typename T, typename RowStrip, typename Store>
+void columnFFTs(const BatchFFT<T>& fft, size_t ncols, RowStrip rowStrip, Store store,
+                size_t width = 0) {
+    using Complex = std::complex<T>;
+    const size_t len = fft.size(), lanes = fft.lanes();
+    // At least 16 complex values (256 bytes for double) per strip
+    if (width == 0) width = std::min(ncols, std::max<size_t>(lanes, 16));
+    const size_t groups = (width + lanes - 1) / lanes;
+
+    #pragma omp parallel
+    {
+        std::vector<T> re(groups * len * lanes, T(0)), im(groups * len * lanes, T(0));
+
+        #pragma omp for schedule(dynamic)
+        for (size_t c0 = 0; c0 < ncols; c0 += width) {
+            // The last block may be narrower; its unused lanes are zeroed
+            const size_t w = std::min(width, ncols - c0), used = (w + lanes - 1) / lanes;
+            for (size_t i = 0; i < len; ++i) {
+                const Complex* strip = rowStrip(i, c0);
+                for (size_t c = 0; c < w; ++c) {
+                    size_t at = (c / lanes) * len * lanes + i * lanes + c % lanes;
+                    re[at] = strip[c].real();
+                    im[at] = strip[c].imag();
+                }
+                for (size_t c = w; c < used * lanes; ++c) {
+                    size_t at = (c / lanes) * len * lanes + i * lanes + c % lanes;
+                    re[at] = im[at] = T(0);
+                }
+            }
+            for (size_t g = 0; g < used; ++g) {
+                fft.transformGroup(re.data() + g * len * lanes, im.data() + g * len * lanes);
+            }
+            for (size_t k = 0; k < len; ++k) {
+                for (size_t c = 0; c < w; ++c) {
+                    size_t at = (c / lanes) * len * lanes + k * lanes + c % lanes;
+                    store(c0 + c, k, Complex(re[at], im[at]));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <future>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+#include "FFT_mixed.h"
+
+// Fast convolution (and correlation) of a long or endless real signal with a
+// fixed FIR filter of m taps, in blocks of an N-point real FFT (FFT_mixed.h).
+//
+// The filter spectrum H is computed once, at construction, scaled by 1/N so
+// the unnormalised inverse needs no extra pass. Each block then costs one
+// forward and one inverse transform of N points for L = N - m + 1 new samples:
+//   OverlapSave  the FFT input is the last m - 1 old samples followed by L new
+//                ones; the first m - 1 outputs are wrapped around and dropped
+//   OverlapAdd   the FFT input is L new samples padded with zeros; the m - 1
+//                samples past the end of each block are added onto the next
+// With correlate = true the filter is reversed, so output n is the correlation
+// at lag n - (m - 1).
+//
+// stream() pulls the signal from a source and pushes the result to a sink in
+// chunks of several blocks, double buffered: while the OpenMP threads transform
+// the blocks of chunk k (blocks are independent, each thread has its own
+// workspace), one extra thread reads chunk k + 1 into the other input buffer and
+// hands the finished output of chunk k - 1 to the sink. The output is the full
+// linear convolution, n + m - 1 samples for n input samples.
+
+enum class OverlapMethod { Add, Save };
+
+inline const char* overlapMethodName(OverlapMethod method) {
+    return method == OverlapMethod::Add ? "overlap-add" : "overlap-save";
+}
+
+template <typename T>
+class FftConvolver {
+public:
+    using Complex = std::complex<T>;
+
+    // fftSize 0 picks the power of two with the least work per output sample
+    FftConvolver(const std::vector<T>& filter, OverlapMethod method = OverlapMethod::Save, size_t fftSize = 0,
+                 bool correlate = false)
+        : m_(filter.size()), n_(fftSize ? fftSize : chooseSize(filter.size())), method_(method), fft_(n_) {
+        if (m_ == 0) throw std::invalid_argument("FftConvolver: empty filter");
+        // Overlap-add relies on at most two blocks overlapping any output sample
+        if (n_ < 2 * m_ || n_ % 2 != 0) throw std::invalid_argument("FftConvolver: FFT size must be even and >= 2m");
+        hop_ = n_ - m_ + 1;
+
+        std::vector<T> padded(n_, T(0));
+        for (size_t k = 0; k < m_; ++k) padded[k] = (correlate ? filter[m_ - 1 - k] : filter[k]) / static_cast<T>(n_);
+        spectrum_.resize(fft_.bins());
+        fft_.forward(padded.data(), spectrum_.data());
+    }
+
+    size_t filterLength() const { return m_; }
+    size_t fftSize() const { return n_; }
+    // New input samples per block
+    size_t hop() const { return hop_; }
+    OverlapMethod method() const { return method_; }
+
+    // read(T* buffer, size_t max) returns how many samples it stored, 0 at the
+    // end; write(const T* buffer, size_t count) receives the output in order.
+    // Returns the number of output samples. blocksPerChunk 0 means 8 per thread.
+    template <typename Read, typename Write>
+    size_t stream(Read read, Write write, size_t blocksPerChunk = 0) const {
+        if (blocksPerChunk == 0) blocksPerChunk = 8 * omp_get_max_threads();
+        const size_t capacity = blocksPerChunk * hop_;
+        const size_t prefix = method_ == OverlapMethod::Save ? m_ - 1 : 0;
+        // The m - 1 zeros after the end flush the filter
+        size_t padding = m_ - 1;
+        bool ended = false;
+
+        // Fills in[prefix ..) with up to capacity samples; for overlap-save the
+        // prefix is the m - 1 samples before them, the end of the previous chunk
+        auto fill = [&](std::vector<T>& in, const std::vector<T>& previous, size_t previousCount) {
+            if (prefix) std::copy(previous.begin() + previousCount, previous.begin() + previousCount + prefix, in.begin());
+            size_t count = 0;
+            while (!ended && count < capacity) {
+                size_t got = read(in.data() + prefix + count, capacity - count);
+                if (got == 0) ended = true;
+                count += got;
+            }
+            size_t zeros = std::min(padding, capacity - count);
+            std::fill(in.begin() + prefix + count, in.end(), T(0));
+            padding -= zeros;
+            return count + zeros;
+        };
+
+        std::vector<T> in[2], out[2];
+        for (int b = 0; b < 2; ++b) {
+            // Room for the last block to read N samples past any start
+            in[b].assign(prefix + capacity + n_, T(0));
+            out[b].resize(capacity);
+        }
+        std::vector<T> carry(m_ - 1, T(0));  // overlap-add tail
+        std::vector<T> blocks(method_ == OverlapMethod::Add ? blocksPerChunk * n_ : 0);
+
+        size_t total = 0, count = fill(in[0], in[1], 0), pending = 0;
+        int cur = 0;
+        while (count > 0) {
+            int other = 1 - cur;
+            auto next = std::async(std::launch::async, [&, other, pending] {
+                if (pending) write(out[other].data(), pending);
+                return fill(in[other], in[cur], count);
+            });
+            if (method_ == OverlapMethod::Save) computeSave(in[cur], out[cur], count);
+            else computeAdd(in[cur], out[cur], count, blocks, carry);
+            total += count;
+            pending = count;
+            count = next.get();
+            cur = other;
+        }
+        if (pending) write(out[1 - cur].data(), pending);
+        return total;
+    }
+
+    // Full linear convolution of x, x.size() + m - 1 samples
+    std::vector<T> convolve(const std::vector<T>& x) const {
+        std::vector<T> y;
+        y.reserve(x.size() + m_ - 1);
+        size_t at = 0;
+        stream([&](T* buffer, size_t max) {
+                   size_t count = std::min(max, x.size() - at);
+                   std::copy(x.begin() + at, x.begin() + at + count, buffer);
+                   at += count;
+                   return count;
+               },
+               [&](const T* buffer, size_t count) { y.insert(y.end(), buffer, buffer + count); });
+        return y;
+    }
+
+private:
+    size_t m_, n_, hop_;
+    OverlapMethod method_;
+    RealFFT<T> fft_;
+    std::vector<Complex> spectrum_;  // H / N
+
+    // Minimises N log2 N / (N - m + 1) over powers of two from 2m, and from 1024
+    // so the per-block overhead stays small for short filters
+    static size_t chooseSize(size_t m) {
+        size_t best = 0;
+        double bestCost = 0.0;
+        for (size_t n = 1024; n <= (size_t(1) << 24); n *= 2) {
+            if (n < 2 * m) continue;
+            double cost = n * std::log2(static_cast<double>(n)) / static_cast<double>(n - m + 1);
+            if (best == 0 || cost < bestCost) best = n, bestCost = cost;
+        }
+        return best;
+    }
+
+    static Complex mul(const Complex& a, const Complex& b) {
+        return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    // time[0 .. N) -> time * h, circularly, in place
+    void filterBlock(T* time, Complex* bins, Complex* work) const {
+        fft_.forward(time, bins, work);
+        for (size_t k = 0; k < fft_.bins(); ++k) bins[k] = mul(bins[k], spectrum_[k]);
+        fft_.inverse(bins, time, work);
+    }
+
+    void computeSave(const std::vector<T>& in, std::vector<T>& out, size_t count) const {
+        const size_t nblocks = (count + hop_ - 1) / hop_;
+        #pragma omp parallel
+        {
+            std::vector<T> time(n_);
+            std::vector<Complex> bins(fft_.bins()), work(fft_.workspaceSize());
+            #pragma omp for schedule(dynamic)
+            for (size_t b = 0; b < nblocks; ++b) {
+                std::copy(in.begin() + b * hop_, in.begin() + b * hop_ + n_, time.begin());
+                filterBlock(time.data(), bins.data(), work.data());
+                size_t keep = std::min(hop_, count - b * hop_);
+                std::copy(time.begin() + (m_ - 1), time.begin() + (m_ - 1) + keep, out.begin() + b * hop_);
+            }
+        }
+    }
+
+    void computeAdd(const std::vector<T>& in, std::vector<T>& out, size_t count, std::vector<T>& blocks,
+                    std::vector<T>& carry) const {
+        const size_t nblocks = (count + hop_ - 1) / hop_;
+        #pragma omp parallel
+        {
+            std::vector<Complex> bins(fft_.bins()), work(fft_.workspaceSize());
+            #pragma omp for schedule(dynamic)
+            for (size_t b = 0; b < nblocks; ++b) {
+                T* time = blocks.data() + b * n_;
+                std::copy(in.begin() + b * hop_, in.begin() + (b + 1) * hop_, time);
+                std::fill(time + hop_, time + n_, T(0));
+                filterBlock(time, bins.data(), work.data());
+            }
+        }
+
+        // Output i of the chunk gets block i / L and the tail of the block before
+        auto at = [&](size_t i) {
+            size_t b = i / hop_;
+            T sum = i < m_ - 1 ? carry[i] : T(0);
+            if (b < nblocks) sum += blocks[b * n_ + i - b * hop_];
+            if (b > 0 && b - 1 < nblocks && i - (b - 1) * hop_ < n_) sum += blocks[(b - 1) * n_ + i - (b - 1) * hop_];
+            return sum;
+        };
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < count; ++i) out[i] = at(i);
+        std::vector<T> next(m_ - 1);
+        for (size_t j = 0; j < m_ - 1; ++j) next[j] = at(count + j);
+        carry.swap(next);
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include "FFT_batch.h"
+
+// Four-step FFT for transforms far larger than the caches (2^20 .. 2^28 points).
+//
+// With n = n1 n2, input index j = n2 j1 + j2 and output index k = k1 + n1 k2,
+//   X[k1 + n1 k2] = sum_j2 w_n2^(j2 k2) [ w_n^(j2 k1) sum_j1 x[n2 j1 + j2] w_n1^(j1 k1) ]
+// i.e. the input is an n1 x n2 matrix and the classic steps are
+//   1. n2 column FFTs of length n1      3. n1 row FFTs of length n2
+//   2. multiply by the twiddles w_n^(j2 k1)   4. transpose into natural order
+// Columns are strided, so both FFT steps here work on blocks of adjacent
+// columns (columnFFTs in FFT_batch.h): every matrix row contributes one short
+// contiguous strip, the strips are gathered into lane-interleaved buffers that
+// fit in cache, and the sub-FFTs of a block run on SIMD lanes side by side. The
+// transposes are folded into the gathers and scatters, blockwise:
+//   pass 1  column blocks of the input -> FFT over j1 -> twiddle -> written
+//           transposed, column j2 becoming row j2 of an n2 x n1 matrix in out[]
+//   pass 2  column blocks of that matrix -> FFT over j2 -> written back in
+//           place, which is already the natural output order k1 + n1 k2
+// Blocks are independent, so each pass is one parallel loop over blocks. The
+// input is only read, once, in pass 1, so it can live in read-only memory such
+// as a memory-mapped file; out[] is the only n-sized buffer that gets written.
+//
+// w_n^e for e < n comes from two tables of about sqrt(n) entries each
+// (e = hi * 2^h + lo), not an n-entry table.
+
+template <typename T>
+class FourStepFFT {
+public:
+    using Complex = std::complex<T>;
+
+    explicit FourStepFFT(size_t n, int direction = -1, SimdIsa isa = detectIsa())
+        : n_(n), log2n_(log2Exact(n)), n1_(size_t(1) << ((log2n_ + 1) / 2)), n2_(n / n1_),
+          columns_(n1_, 0, direction, isa), rows_(n2_, 0, direction, isa) {
+        lowBits_ = (log2n_ + 1) / 2;
+        const double pi = std::acos(-1.0);
+        size_t low = size_t(1) << lowBits_;
+        for (size_t e = 0; e < low; ++e) twiddleLow_.push_back(root(direction, pi, e));
+        for (size_t e = 0; e < n_ / low; ++e) twiddleHigh_.push_back(root(direction, pi, e * low));
+    }
+
+    size_t size() const { return n_; }
+    size_t rows() const { return n1_; }
+    size_t cols() const { return n2_; }
+    SimdIsa isa() const { return columns_.isa(); }
+
+    // out = DFT(in), unnormalised; in is only read and must not overlap out
+    void execute(const Complex* in, Complex* out) const {
+        // Pass 1: columns j2 of the n1 x n2 input, written as rows of out (n2 x n1)
+        columnFFTs(columns_, n2_, [&](size_t j1, size_t col) { return in + n2_ * j1 + col; },
+                   [&](size_t j2, size_t k1, Complex v) { out[n1_ * j2 + k1] = v * twiddle(j2 * k1); });
+        // Pass 2: columns k1 of out (n2 x n1), in place
+        columnFFTs(rows_, n1_, [&](size_t j2, size_t col) { return out + n1_ * j2 + col; },
+                   [&](size_t k1, size_t k2, Complex v) { out[n1_ * k2 + k1] = v; });
+    }
+
+private:
+    size_t n_;
+    int log2n_;
+    size_t n1_, n2_;
+    BatchFFT<T> columns_, rows_;  // lane-interleaved transforms of length n1 and n2
+    int lowBits_;
+    std::vector<Complex> twiddleLow_, twiddleHigh_;
+
+    static int log2Exact(size_t n) {
+        if (n == 0 || (n & (n - 1)) != 0) throw std::invalid_argument("FourStepFFT: size must be a power of two");
+        int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        return bits;
+    }
+
+    Complex root(int direction, double pi, size_t e) const {
+        double angle = direction * 2.0 * pi * static_cast<double>(e) / static_cast<double>(n_);
+        return Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+    }
+
+    Complex twiddle(size_t e) const {
+        const Complex& a = twiddleHigh_[e >> lowBits_];
+        const Complex& b = twiddleLow_[e & ((size_t(1) << lowBits_) - 1)];
+        return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+};
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "FFT_radix.h"
+#include "FFT_reference.h"
+
+// Iterative in-place radix-2/4 FFT (FFT_radix.h) on the same 2^20 all-ones input
+// as FFT_seq.cpp. With "check" it also runs the recursive fft() from FFT_seq.cpp
+// (FFT_reference.h) on the same inputs and reports how far apart the results are.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+// Largest |x - y| relative to the largest |y|
+double relativeError(const vector<Complex>& x, const vector<Complex>& y) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        err = max(err, abs(x[i] - y[i]));
+        scale = max(scale, abs(y[i]));
+    }
+    return scale > 0.0 ? err / scale : err;
+}
+
+// Compares the iterative transform with the recursive one and checks the inverse
+bool check(int n) {
+    mt19937_64 gen(42);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    vector<Complex> ones(n, 1), random(n);
+    for (auto& x : random) x = Complex(dist(gen), dist(gen));
+
+    IterativeFFT<double> forward(n, -1), inverse(n, 1);
+    bool ok = true;
+    for (auto* input : {&ones, &random}) {
+        vector<Complex> reference(n);
+        auto t0 = chrono::high_resolution_clock::now();
+        fftRecursive(*input, reference, 0, n, 1);
+        auto t1 = chrono::high_resolution_clock::now();
+        vector<Complex> result = *input;
+        forward(result);
+        auto t2 = chrono::high_resolution_clock::now();
+
+        vector<Complex> roundTrip = result;
+        inverse(roundTrip);
+        for (auto& x : roundTrip) x /= n;
+
+        double err = relativeError(result, reference);
+        double roundErr = relativeError(roundTrip, *input);
+        bool good = err < 1e-10 && roundErr < 1e-12;
+        ok = ok && good;
+        cout << (input == &ones ? "All-ones input: " : "Random input:   ")
+             << "max relative error vs recursive " << err << ", inverse round trip " << roundErr
+             << (good ? " (ok)" : " (FAILED)") << "\n"
+             << "  recursive " << chrono::duration<double>(t1 - t0).count() << " s, iterative "
+             << chrono::duration<double>(t2 - t1).count() << " s\n";
+    }
+    return ok;
+}
+
+// Usage: ./cpp_FFT_iterative [log2n]         time the transform
+//        ./cpp_FFT_iterative check [log2n]   compare with the recursive fft()
+int main(int argc, char* argv[]) {
+    bool doCheck = argc > 1 && string(argv[1]) == "check";
+    int argLog = doCheck ? 2 : 1;
+    int n = 1 << (argc > argLog ? stoi(argv[argLog]) : 20); // default 2^20 = 1,048,576 points
+
+    if (doCheck) return check(n) ? 0 : 1;
+
+    vector<Complex> data(n, 1); // All values set to 1
+
+    auto start_time = chrono::high_resolution_clock::now();
+
+    IterativeFFT<double> plan(n);
+    plan(data);
+
+    auto end_time = chrono::high_resolution_clock::now();
+    chrono::duration<double> duration = end_time - start_time;
+
+    cout << "Iterative FFT done in: " << duration.count() << " seconds" << endl;
+
+    return 0;
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+
+// FFTs for any length, and for real input.
+//
+// MixedFFT<T> handles every n >= 1:
+//   - n = 2^a 3^b 5^c 7^d: self-sorting (Stockham) decimation in frequency. A
+//     stage of radix r (4 first, then 2, 3, 5, 7) turns one length-L problem at
+//     stride s into r length-L/r problems at stride r*s, ping-ponging between the
+//     output array and one work array, so no bit reversal is needed. The stage
+//     twiddles w_L^(p u) are precomputed.
+//   - any other n: Bluestein's chirp-z algorithm. With c_t = e^(dir pi i t^2 / n),
+//     X_k = c_k sum_j (x_j c_j) conj(c_(k-j)), a convolution evaluated with a
+//     power-of-two MixedFFT of length M >= 2n - 1. The chirp and the spectrum of
+//     conj(c) are precomputed.
+//
+// RealFFT<T> transforms n real samples (n even) into the n/2 + 1 non-redundant
+// bins by treating them as n/2 complex samples z_j = x_2j + i x_2j+1, running a
+// MixedFFT of length n/2 and separating the even/odd spectra afterwards; inverse()
+// undoes the steps. Odd n goes through a full complex transform.
+//
+// Forward is direction -1, and nothing is normalised: inverse(forward(x)) = n x,
+// as in FFTW.
+
+template <typename T>
+class MixedFFT {
+public:
+    using Complex = std::complex<T>;
+
+    explicit MixedFFT(size_t n, int direction = -1) : n_(n), direction_(direction) {
+        if (n == 0) throw std::invalid_argument("MixedFFT: size must be positive");
+        if (direction != -1 && direction != 1) throw std::invalid_argument("MixedFFT: direction must be -1 or +1");
+
+        size_t rest = n;
+        for (int r : {4, 2, 3, 5, 7}) {
+            while (rest % r == 0) {
+                radices_.push_back(r);
+                rest /= r;
+            }
+        }
+        if (rest != 1) {
+            setupBluestein();
+            return;
+        }
+
+        const double pi = std::acos(-1.0);
+        size_t length = n;
+        for (int r : radices_) {
+            size_t m = length / r;
+            for (size_t p = 0; p < m; ++p) {
+                for (int u = 1; u < r; ++u) {
+                    double angle = direction * 2.0 * pi * static_cast<double>(p * u) / static_cast<double>(length);
+                    twiddles_.push_back(Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle))));
+                }
+            }
+            length = m;
+        }
+        for (int t = 0; t < 7; ++t) {
+            double angle = direction * 2.0 * pi * t / 7;
+            roots7_.push_back(Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle))));
+        }
+    }
+
+    size_t size() const { return n_; }
+    int direction() const { return direction_; }
+    bool usesBluestein() const { return bluestein_ != nullptr; }
+
+    // Elements of Complex that operator()(in, out, work) needs in 'work'
+    size_t workspaceSize() const { return bluestein_ ? 2 * bluestein_->size() + bluestein_->workspaceSize() : n_; }
+
+    // out = DFT(in); in == out is allowed
+    void operator()(const Complex* in, Complex* out) const {
+        std::vector<Complex> work(workspaceSize());
+        (*this)(in, out, work.data());
+    }
+
+    void operator()(const Complex* in, Complex* out, Complex* work) const {
+        if (bluestein_) {
+            runBluestein(in, out, work);
+            return;
+        }
+        if (in != out) std::copy(in, in + n_, out);
+        Complex* x = out;
+        Complex* y = work;
+        size_t length = n_, stride = 1;
+        const Complex* tw = twiddles_.data();
+        for (int r : radices_) {
+            size_t m = length / r;
+            stage(r, m, stride, tw, x, y);
+            tw += m * (r - 1);
+            std::swap(x, y);
+            length = m;
+            stride *= r;
+        }
+        if (x != out) std::copy(x, x + n_, out);
+    }
+
+    void operator()(std::vector<Complex>& data) const { (*this)(data.data(), data.data()); }
+
+private:
+    size_t n_;
+    int direction_;
+    std::vector<int> radices_;
+    std::vector<Complex> twiddles_;  // per stage: w_L^(p u), p < L/r, u = 1 .. r-1
+    std::vector<Complex> roots7_;
+    // Radix-3/5 butterfly constants; rotate() supplies the sign of the sines
+    const T sin60_ = static_cast<T>(std::sqrt(3.0) / 2);
+    const T cos72_ = static_cast<T>(std::cos(0.4 * std::acos(-1.0)));
+    const T sin72_ = static_cast<T>(std::sin(0.4 * std::acos(-1.0)));
+    const T cos144_ = static_cast<T>(std::cos(0.8 * std::acos(-1.0)));
+    const T sin144_ = static_cast<T>(std::sin(0.8 * std::acos(-1.0)));
+
+    // Bluestein: chirp c_k (n values), spectrum of conj(c) at length M, and the
+    // two power-of-two transforms of length M
+    std::vector<Complex> chirp_, filter_;
+    std::unique_ptr<MixedFFT> bluestein_, bluesteinInverse_;
+
+    static Complex mul(const Complex& a, const Complex& b) {
+        return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    // Multiplication by dir * i
+    Complex rotate(const Complex& a) const {
+        return direction_ < 0 ? Complex(a.imag(), -a.real()) : Complex(-a.imag(), a.real());
+    }
+
+    // One Stockham stage: length L = r m problems at 'stride'; element p of the
+    // problem at offset q is x[q + stride (p + t m)] for part t, and output u of
+    // butterfly p goes to y[q + stride (r p + u)], multiplied by w_L^(p u)
+    void stage(int r, size_t m, size_t stride, const Complex* tw, const Complex* x, Complex* y) const {
+        const size_t s = stride;
+        for (size_t p = 0; p < m; ++p) {
+            const Complex* w = tw + p * (r - 1);
+            const Complex* in = x + s * p;
+            Complex* out = y + s * r * p;
+            switch (r) {
+                case 2:
+                    for (size_t q = 0; q < s; ++q) {
+                        Complex a = in[q], b = in[q + s * m];
+                        out[q] = a + b;
+                        out[q + s] = mul(a - b, w[0]);
+                    }
+                    break;
+                case 4:
+                    for (size_t q = 0; q < s; ++q) {
+                        Complex a = in[q], b = in[q + s * m], c = in[q + 2 * s * m], d = in[q + 3 * s * m];
+                        Complex t0 = a + c, t1 = a - c, t2 = b + d, t3 = rotate(b - d);
+                        out[q] = t0 + t2;
+                        out[q + s] = mul(t1 + t3, w[0]);
+                        out[q + 2 * s] = mul(t0 - t2, w[1]);
+                        out[q + 3 * s] = mul(t1 - t3, w[2]);
+                    }
+                    break;
+                case 3:
+                    for (size_t q = 0; q < s; ++q) {
+                        Complex a = in[q], b = in[q + s * m], c = in[q + 2 * s * m];
+                        Complex t1 = b + c;
+                        Complex m1 = a - t1 * T(0.5), m2 = rotate((b - c) * sin60_);
+                        out[q] = a + t1;
+                        out[q + s] = mul(m1 + m2, w[0]);
+                        out[q + 2 * s] = mul(m1 - m2, w[1]);
+                    }
+                    break;
+                case 5:
+                    for (size_t q = 0; q < s; ++q) {
+                        Complex a = in[q], b = in[q + s * m], c = in[q + 2 * s * m];
+                        Complex d = in[q + 3 * s * m], e = in[q + 4 * s * m];
+                        Complex t1 = b + e, t2 = c + d, t3 = b - e, t4 = c - d;
+                        Complex m1 = a + t1 * cos72_ + t2 * cos144_, m2 = a + t1 * cos144_ + t2 * cos72_;
+                        Complex n1 = rotate(t3 * sin72_ + t4 * sin144_), n2 = rotate(t3 * sin144_ - t4 * sin72_);
+                        out[q] = a + t1 + t2;
+                        out[q + s] = mul(m1 + n1, w[0]);
+                        out[q + 2 * s] = mul(m2 + n2, w[1]);
+                        out[q + 3 * s] = mul(m2 - n2, w[2]);
+                        out[q + 4 * s] = mul(m1 - n1, w[3]);
+                    }
+                    break;
+                default: {
+                    // Radix 7: direct 7-point DFT with the stored roots
+                    Complex a[7];
+                    for (size_t q = 0; q < s; ++q) {
+                        for (int t = 0; t < r; ++t) a[t] = in[q + t * s * m];
+                        for (int u = 0; u < r; ++u) {
+                            Complex sum = a[0];
+                            for (int t = 1; t < r; ++t) sum += mul(a[t], roots7_[(t * u) % r]);
+                            out[q + u * s] = u == 0 ? sum : mul(sum, w[u - 1]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void setupBluestein() {
+        radices_.clear();
+        size_t m = 1;
+        while (m < 2 * n_ - 1) m *= 2;
+        bluestein_.reset(new MixedFFT(m, -1));
+        bluesteinInverse_.reset(new MixedFFT(m, 1));
+
+        // t^2 mod 2n keeps the angle small and exact for large t
+        const long double pi = std::acos(-1.0L);
+        chirp_.resize(n_);
+        for (size_t t = 0; t < n_; ++t) {
+            unsigned long long sq = static_cast<unsigned long long>(t) * t % (2 * n_);
+            long double angle = direction_ * pi * static_cast<long double>(sq) / n_;
+            chirp_[t] = Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle)));
+        }
+        std::vector<Complex> b(m, Complex(0));
+        for (size_t t = 0; t < n_; ++t) {
+            b[t] = std::conj(chirp_[t]);
+            if (t > 0) b[m - t] = b[t];
+        }
+        filter_.resize(m);
+        (*bluestein_)(b.data(), filter_.data());
+        // Fold the 1/M of the inverse transform into the filter
+        for (auto& f : filter_) f /= static_cast<T>(m);
+    }
+
+    void runBluestein(const Complex* in, Complex* out, Complex* work) const {
+        const size_t m = bluestein_->size();
+        Complex* a = work;
+        Complex* spectrum = work + m;
+        Complex* inner = work + 2 * m;
+        for (size_t j = 0; j < n_; ++j) a[j] = mul(in[j], chirp_[j]);
+        std::fill(a + n_, a + m, Complex(0));
+        (*bluestein_)(a, spectrum, inner);
+        for (size_t k = 0; k < m; ++k) spectrum[k] = mul(spectrum[k], filter_[k]);
+        (*bluesteinInverse_)(spectrum, a, inner);
+        for (size_t k = 0; k < n_; ++k) out[k] = mul(a[k], chirp_[k]);
+    }
+};
+
+template <typename T>
+class RealFFT {
+public:
+    using Complex = std::complex<T>;
+
+    explicit RealFFT(size_t n)
+        : n_(n), half_(n % 2 == 0 ? n / 2 : n), forward_(half_, -1), inverse_(half_, 1) {
+        const double pi = std::acos(-1.0);
+        if (n % 2 == 0) {
+            for (size_t k = 0; k < half_; ++k) {
+                double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(n);
+                twiddles_.push_back(Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle))));
+            }
+        }
+    }
+
+    size_t size() const { return n_; }
+    // Number of output bins: n/2 + 1
+    size_t bins() const { return n_ / 2 + 1; }
+
+    // Elements of Complex that forward/inverse need in 'work'
+    size_t workspaceSize() const { return half_ + forward_.workspaceSize(); }
+
+    // spectrum[k] = sum_j x[j] e^(-2 pi i jk / n), k = 0 .. n/2
+    void forward(const T* x, Complex* spectrum) const {
+        std::vector<Complex> work(workspaceSize());
+        forward(x, spectrum, work.data());
+    }
+
+    void forward(const T* x, Complex* spectrum, Complex* work) const {
+        Complex* z = work;
+        if (n_ % 2 == 1) {
+            for (size_t j = 0; j < n_; ++j) z[j] = Complex(x[j], 0);
+            forward_(z, z, work + half_);
+            std::copy(z, z + bins(), spectrum);
+            return;
+        }
+
+        for (size_t j = 0; j < half_; ++j) z[j] = Complex(x[2 * j], x[2 * j + 1]);
+        forward_(z, z, work + half_);
+
+        // Z = E + iO with E, O the spectra of the even and odd samples
+        for (size_t k = 0; k <= half_; ++k) {
+            Complex zk = z[k % half_], zc = std::conj(z[(half_ - k) % half_]);
+            Complex even = (zk + zc) * T(0.5);
+            Complex odd = Complex(0, -0.5) * (zk - zc);
+            Complex w = k < half_ ? twiddles_[k] : Complex(-1, 0);
+            spectrum[k] = even + w * odd;
+        }
+    }
+
+    // x = n * IDFT(spectrum) for the Hermitian spectrum given by its n/2 + 1 bins
+    void inverse(const Complex* spectrum, T* x) const {
+        std::vector<Complex> work(workspaceSize());
+        inverse(spectrum, x, work.data());
+    }
+
+    void inverse(const Complex* spectrum, T* x, Complex* work) const {
+        Complex* z = work;
+        if (n_ % 2 == 1) {
+            for (size_t k = 0; k < n_; ++k) z[k] = k < bins() ? spectrum[k] : std::conj(spectrum[n_ - k]);
+            inverse_(z, z, work + half_);
+            for (size_t j = 0; j < n_; ++j) x[j] = z[j].real();
+            return;
+        }
+
+        // Rebuild Z = E + iO (times 2, so the half-length inverse gives n x)
+        for (size_t k = 0; k < half_; ++k) {
+            Complex xk = spectrum[k], xc = std::conj(spectrum[half_ - k]);
+            Complex even = xk + xc;
+            Complex odd = (xk - xc) * std::conj(twiddles_[k]);
+            z[k] = even + Complex(0, 1) * odd;
+        }
+        inverse_(z, z, work + half_);
+        for (size_t j = 0; j < half_; ++j) {
+            x[2 * j] = z[j].real();
+            x[2 * j + 1] = z[j].imag();
+        }
+    }
+
+private:
+    size_t n_, half_;
+    MixedFFT<T> forward_, inverse_;
+    std::vector<Complex> twiddles_;  // e^(-2 pi i k / n), k < n/2
+};
@@ -0,0 +1,250 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <omp.h>
+#include "FFT_nd.h"
+#include "FFT_radix.h"
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+// 2D/3D FFT (FFT_nd.h) of a row-major array, default 4096 x 4096 complex
+// doubles. It is timed against the plain row-column method (every line copied
+// out, transformed with FFT_radix.h and copied back, one thread) and both
+// results are compared.
+//
+// Built with -DUSE_MPI the array is 3D and split into pencils over a p1 x p2
+// grid of ranks (p1 defaults to the largest divisor of the rank count not above
+// its square root):
+//   Z pencils  [n0/p1][n1/p2][n2]  FFT along axis 2
+//     all-to-all among the p2 ranks of a row
+//   Y pencils  [n0/p1][n1][n2/p2]  FFT along axis 1
+//     all-to-all among the p1 ranks of a column
+//   X pencils  [n0][n1/p1][n2/p2]  FFT along axis 0
+// The output stays in X pencils, as in most pencil libraries. Up to 2^24
+// points rank 0 gathers it and compares with NdFFT on the whole array.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+// Reproducible input, computable from the global index alone
+Complex sample(uint64_t g) {
+    uint64_t h = (g + 1) * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 29;
+    double a = static_cast<double>(h % 1000003) / 1000003.0 - 0.5;
+    double b = static_cast<double>((h >> 20) % 1000003) / 1000003.0 - 0.5;
+    return Complex(a, b);
+}
+
+double maxError(const vector<Complex>& a, const vector<Complex>& b) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        err = max(err, abs(a[i] - b[i]));
+        scale = max(scale, abs(b[i]));
+    }
+    return err / scale;
+}
+
+double gflops(size_t total, double seconds) { return 5.0 * total * log2(static_cast<double>(total)) / seconds * 1e-9; }
+
+// Row-column method: each line along each axis through a line buffer
+void rowColumn(vector<Complex>& data, const vector<size_t>& dims) {
+    for (size_t a = 0; a < dims.size(); ++a) {
+        size_t outer = 1, inner = 1, len = dims[a];
+        for (size_t b = 0; b < a; ++b) outer *= dims[b];
+        for (size_t b = a + 1; b < dims.size(); ++b) inner *= dims[b];
+        IterativeFFT<double> fft(len);
+        vector<Complex> line(len);
+        for (size_t o = 0; o < outer; ++o) {
+            for (size_t s = 0; s < inner; ++s) {
+                Complex* base = data.data() + o * len * inner + s;
+                for (size_t i = 0; i < len; ++i) line[i] = base[i * inner];
+                fft(line);
+                for (size_t i = 0; i < len; ++i) base[i * inner] = line[i];
+            }
+        }
+    }
+}
+
+#ifdef USE_MPI
+// Z [a0][a1][n2] -> Y [a0][n1][n2/p] among the p ranks of a row: axis 2 is cut
+// into one piece per rank, and the piece from rank q lands at i1 = q a1 + j1
+// through the send/recv buffers of the same size
+void transposeZY(const vector<Complex>& z, vector<Complex>& y, vector<Complex>& send, vector<Complex>& recv,
+                 size_t a0, size_t a1, size_t n2, MPI_Comm comm) {
+    int p;
+    MPI_Comm_size(comm, &p);
+    size_t b2 = n2 / p, chunk = a0 * a1 * b2;
+    for (int q = 0; q < p; ++q) {
+        for (size_t i0 = 0; i0 < a0; ++i0) {
+            for (size_t j1 = 0; j1 < a1; ++j1) {
+                const Complex* row = z.data() + (i0 * a1 + j1) * n2 + q * b2;
+                copy(row, row + b2, send.data() + q * chunk + (i0 * a1 + j1) * b2);
+            }
+        }
+    }
+    MPI_Alltoall(send.data(), 2 * chunk, MPI_DOUBLE, recv.data(), 2 * chunk, MPI_DOUBLE, comm);
+    size_t n1 = a1 * p;
+    for (int q = 0; q < p; ++q) {
+        for (size_t i0 = 0; i0 < a0; ++i0) {
+            for (size_t j1 = 0; j1 < a1; ++j1) {
+                const Complex* from = recv.data() + q * chunk + (i0 * a1 + j1) * b2;
+                copy(from, from + b2, y.data() + (i0 * n1 + q * a1 + j1) * b2);
+            }
+        }
+    }
+}
+
+// Y [a0][n1][b2] -> X [n0][n1/p][b2] among the p ranks of a column
+void transposeYX(const vector<Complex>& y, vector<Complex>& x, vector<Complex>& send, vector<Complex>& recv,
+                 size_t a0, size_t n1, size_t b2, MPI_Comm comm) {
+    int p;
+    MPI_Comm_size(comm, &p);
+    size_t c1 = n1 / p, chunk = a0 * c1 * b2;
+    for (int q = 0; q < p; ++q) {
+        for (size_t i0 = 0; i0 < a0; ++i0) {
+            const Complex* from = y.data() + (i0 * n1 + q * c1) * b2;
+            copy(from, from + c1 * b2, send.data() + q * chunk + i0 * c1 * b2);
+        }
+    }
+    MPI_Alltoall(send.data(), 2 * chunk, MPI_DOUBLE, recv.data(), 2 * chunk, MPI_DOUBLE, comm);
+    // Rank q's planes are planes q * a0 .. (q + 1) * a0 of x, already in order
+    x.swap(recv);
+}
+
+int runDistributed(int argc, char* argv[]) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t n0 = argc > 3 ? stoul(argv[1]) : 256, n1 = argc > 3 ? stoul(argv[2]) : 256, n2 = argc > 3 ? stoul(argv[3]) : 256;
+    int p1 = argc > 4 ? stoi(argv[4]) : 1;
+    if (argc <= 4) {
+        for (int d = 1; d * d <= size; ++d) {
+            if (size % d == 0) p1 = d;
+        }
+    }
+    int p2 = size / p1;
+    if (p1 * p2 != size || n0 % p1 || n1 % p1 || n1 % p2 || n2 % p2) {
+        if (rank == 0) cerr << "Grid " << p1 << " x " << p2 << " does not divide " << n0 << " x " << n1 << " x " << n2 << "\n";
+        return 1;
+    }
+    int r1 = rank / p2, r2 = rank % p2;
+    MPI_Comm rowComm, colComm;
+    MPI_Comm_split(MPI_COMM_WORLD, r1, r2, &rowComm);
+    MPI_Comm_split(MPI_COMM_WORLD, r2, r1, &colComm);
+
+    size_t a0 = n0 / p1, a1 = n1 / p2, b2 = n2 / p2, c1 = n1 / p1, local = a0 * a1 * n2;
+    vector<Complex> z(local), y(local), x(local), send(local), recv(local);
+    for (size_t i0 = 0; i0 < a0; ++i0) {
+        for (size_t j1 = 0; j1 < a1; ++j1) {
+            for (size_t i2 = 0; i2 < n2; ++i2) {
+                z[(i0 * a1 + j1) * n2 + i2] = sample(((r1 * a0 + i0) * n1 + r2 * a1 + j1) * n2 + i2);
+            }
+        }
+    }
+    BatchFFT<double> fft0(n0, 0), fft1(n1, 0), fft2(n2, 0);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    double t0 = MPI_Wtime(), compute = 0.0;
+    double c = MPI_Wtime();
+    fftAxis(fft2, z.data(), a0 * a1, 1);
+    compute += MPI_Wtime() - c;
+    transposeZY(z, y, send, recv, a0, a1, n2, rowComm);
+    c = MPI_Wtime();
+    fftAxis(fft1, y.data(), a0, b2);
+    compute += MPI_Wtime() - c;
+    transposeYX(y, x, send, recv, a0, n1, b2, colComm);
+    c = MPI_Wtime();
+    fftAxis(fft0, x.data(), 1, c1 * b2);
+    compute += MPI_Wtime() - c;
+    double seconds = MPI_Wtime() - t0, slowest;
+    MPI_Reduce(&seconds, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    size_t total = n0 * n1 * n2;
+    if (rank == 0) {
+        cout << n0 << " x " << n1 << " x " << n2 << " on " << p1 << " x " << p2 << " ranks, " << omp_get_max_threads()
+             << " thread(s) each, " << isaName(fft0.isa()) << "\n";
+        cout << "Pencil FFT: " << slowest << " seconds, " << gflops(total, slowest) << " GFLOP/s ("
+             << seconds - compute << " s of rank 0 in transposes)\n";
+    }
+
+    int status = 0;
+    if (total <= (size_t(1) << 24)) {
+        vector<Complex> all(rank == 0 ? total : 0);
+        MPI_Gather(x.data(), 2 * local, MPI_DOUBLE, all.data(), 2 * local, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            vector<Complex> reference(total), result(total);
+            for (size_t g = 0; g < total; ++g) reference[g] = sample(g);
+            NdFFT<double>({n0, n1, n2}).execute(reference.data());
+            // Rank (q1, q2) holds [n0][c1][b2] at global (i0, q1 c1 + j1, q2 b2 + j2)
+            for (int q = 0; q < size; ++q) {
+                size_t q1 = q / p2, q2 = q % p2;
+                for (size_t i0 = 0; i0 < n0; ++i0) {
+                    for (size_t j1 = 0; j1 < c1; ++j1) {
+                        for (size_t j2 = 0; j2 < b2; ++j2) {
+                            result[(i0 * n1 + q1 * c1 + j1) * n2 + q2 * b2 + j2] =
+                                all[q * local + (i0 * c1 + j1) * b2 + j2];
+                        }
+                    }
+                }
+            }
+            double err = maxError(result, reference);
+            cout << "Max relative difference from NdFFT: " << err << "\n";
+            cout << (err < 1e-12 ? "Result ok\n" : "Result MISMATCH\n");
+            status = err < 1e-12 ? 0 : 1;
+        }
+    }
+    MPI_Comm_free(&rowComm);
+    MPI_Comm_free(&colComm);
+    return status;
+}
+#endif
+
+// Usage: ./cpp_FFT_nd [n0 n1 [n2]]          (default 4096 4096)
+//        mpirun -n P ./cpp_FFT_nd_mpi [n0 n1 n2 [p1]]   (default 256 256 256)
+int main(int argc, char* argv[]) {
+#ifdef USE_MPI
+    MPI_Init(&argc, &argv);
+    int status = runDistributed(argc, argv);
+    MPI_Finalize();
+    return status;
+#else
+    vector<size_t> dims;
+    for (int i = 1; i < argc && i <= 3; ++i) dims.push_back(stoul(argv[i]));
+    if (dims.size() < 2) dims = {4096, 4096};
+
+    NdFFT<double> fft(dims);
+    size_t total = fft.size();
+    vector<Complex> input(total);
+    #pragma omp parallel for schedule(static)
+    for (size_t g = 0; g < total; ++g) input[g] = sample(g);
+
+    cout << dims[0];
+    for (size_t a = 1; a < dims.size(); ++a) cout << " x " << dims[a];
+    cout << " complex doubles, " << omp_get_max_threads() << " thread(s), " << isaName(fft.isa()) << "\n";
+
+    vector<Complex> reference = input;
+    double t0 = omp_get_wtime();
+    rowColumn(reference, dims);
+    double t = omp_get_wtime() - t0;
+    cout << "Row-column, one thread: " << t << " seconds, " << gflops(total, t) << " GFLOP/s\n";
+
+    vector<Complex> result = input;
+    fft.execute(result.data());  // warm up
+    result = input;
+    t0 = omp_get_wtime();
+    fft.execute(result.data());
+    t = omp_get_wtime() - t0;
+    cout << "NdFFT                 : " << t << " seconds, " << gflops(total, t) << " GFLOP/s\n";
+
+    double err = maxError(result, reference);
+    cout << "Max relative difference: " << err << "\n";
+    cout << (err < 1e-12 ? "Result ok\n" : "Result MISMATCH\n");
+    return err < 1e-12 ? 0 : 1;
+#endif
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include "FFT_batch.h"
+
+// Multi-dimensional (2D/3D, or any rank) FFT of a row-major array, as batched
+// 1D transforms along one axis after another.
+//
+// Seen along axis a, the array is outer x len x inner (outer = product of the
+// earlier extents, inner = product of the later ones):
+//   - the last axis (inner == 1) is a batch of outer contiguous signals,
+//     transformed by BatchFFT::execute with W signals per SIMD register
+//   - any other axis is a set of outer * inner strided columns; columnFFTs
+//     gathers blocks of adjacent columns (contiguous strips of each row) into
+//     cache-sized lane-interleaved buffers, transforms them and scatters them
+//     back, i.e. a cache-blocked transpose there and back around each batch
+// Both are one parallel loop over rows, or over (plane, column block) pairs, so
+// the threads split the work whatever the shape. fftAxis() is public so a
+// distributed transform (FFT_nd.cpp with -DUSE_MPI) can run it on its local
+// pencils.
+//
+// Extents must be powers of two (the SplitFFT kernels); the result is
+// unnormalised.
+
+template <typename T>
+void fftAxis(const BatchFFT<T>& fft, std::complex<T>* data, size_t outer, size_t inner) {
+    const size_t len = fft.size();
+    if (len == 1) return;
+    if (inner == 1) {
+        fft.execute(data, outer, BatchMode::Auto);
+        return;
+    }
+    // Blocks must not straddle two planes, so they are at most inner wide
+    size_t width = std::min(inner, std::max<size_t>(fft.lanes(), 16));
+    auto at = [=](size_t i, size_t c) { return data + (c / inner) * len * inner + i * inner + c % inner; };
+    columnFFTs(fft, outer * inner, [&](size_t i, size_t c) { return at(i, c); },
+               [&](size_t c, size_t k, std::complex<T> v) { *at(k, c) = v; }, width);
+}
+
+template <typename T>
+class NdFFT {
+public:
+    using Complex = std::complex<T>;
+
+    explicit NdFFT(std::vector<size_t> dims, int direction = -1, SimdIsa isa = detectIsa()) : dims_(std::move(dims)) {
+        if (dims_.empty()) throw std::invalid_argument("NdFFT: no dimensions");
+        for (size_t d : dims_) {
+            if (d == 0 || (d & (d - 1)) != 0) throw std::invalid_argument("NdFFT: extents must be powers of two");
+            size_ *= d;
+        }
+        // One plan per distinct extent
+        for (size_t a = 0; a < dims_.size(); ++a) {
+            size_t same = a;
+            for (size_t b = 0; b < a; ++b) {
+                if (dims_[b] == dims_[a]) same = b;
+            }
+            if (same == a) plans_.push_back(std::make_shared<BatchFFT<T>>(dims_[a], 0, direction, isa));
+            else plans_.push_back(plans_[same]);
+        }
+    }
+
+    const std::vector<size_t>& dims() const { return dims_; }
+    size_t size() const { return size_; }
+    SimdIsa isa() const { return plans_[0]->isa(); }
+
+    // data[((i0 * n1) + i1) * n2 + i2 ...] transformed in place
+    void execute(Complex* data) const {
+        // Last axis first: it is the cheapest and leaves the others in cache longest
+        for (size_t a = dims_.size(); a-- > 0;) execute(data, a);
+    }
+
+    // Only along axis a
+    void execute(Complex* data, size_t a) const {
+        size_t outer = 1, inner = 1;
+        for (size_t b = 0; b < a; ++b) outer *= dims_[b];
+        for (size_t b = a + 1; b < dims_.size(); ++b) inner *= dims_[b];
+        fftAxis(*plans_[a], data, outer, inner);
+    }
+
+private:
+    std::vector<size_t> dims_;
+    size_t size_ = 1;
+    std::vector<std::shared_ptr<BatchFFT<T>>> plans_;
+};
@@ -0,0 +1,129 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <omp.h>
+#include "FFT_plan.h"
+#include "FFT_reference.h"
+
+// Streaming use of FftPlan (FFT_plan.h): many frames of the same size are
+// transformed by all OpenMP threads through one shared plan, against
+//   - the recursive fft() of FFT_seq.cpp called per frame (no reuse at all)
+//   - a new IterativeFFT per frame (tables rebuilt on every call)
+// Frame f is generated from f alone. The timed runs keep each frame's spectrum
+// energy, so the threaded and one-thread runs can be compared frame by frame;
+// the spectra of a sample of frames are then compared element by element with
+// the recursive fft.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+void makeFrame(int f, vector<Complex>& frame) {
+    int n = frame.size();
+    for (int i = 0; i < n; ++i) {
+        double t = static_cast<double>(i) / n;
+        frame[i] = Complex(sin(2 * M_PI * (f % 97 + 1) * t) + 0.5 * cos(2 * M_PI * 31 * t + f), 0.25 * sin(f + i));
+    }
+}
+
+double energy(const vector<Complex>& spectrum) {
+    double e = 0.0;
+    for (const auto& x : spectrum) e += norm(x);
+    return e;
+}
+
+// Largest |out[k] - ref[k]|, relative to the largest |ref[k]|
+double relativeError(const vector<Complex>& out, const vector<Complex>& ref) {
+    double diff = 0.0, scale = 0.0;
+    for (size_t k = 0; k < ref.size(); ++k) {
+        diff = max(diff, abs(out[k] - ref[k]));
+        scale = max(scale, abs(ref[k]));
+    }
+    return scale > 0.0 ? diff / scale : diff;
+}
+
+// Runs transform(frame, spectrum) for every frame on all threads; returns seconds
+template <typename Transform>
+double stream(int n, int frames, vector<double>& energies, Transform transform) {
+    double t0 = omp_get_wtime();
+    #pragma omp parallel
+    {
+        vector<Complex> frame(n), spectrum(n);
+        #pragma omp for schedule(dynamic, 16)
+        for (int f = 0; f < frames; ++f) {
+            makeFrame(f, frame);
+            transform(frame, spectrum);
+            energies[f] = energy(spectrum);
+        }
+    }
+    return omp_get_wtime() - t0;
+}
+
+// Usage: ./cpp_FFT_plan [log2n] [frames] [estimate|measure]
+int main(int argc, char* argv[]) {
+    int n = 1 << (argc > 1 ? stoi(argv[1]) : 12);
+    int frames = argc > 2 ? stoi(argv[2]) : 5000;
+    PlanMode mode = argc > 3 && string(argv[3]) == "measure" ? PlanMode::Measure : PlanMode::Estimate;
+
+    double t0 = omp_get_wtime();
+    FftPlan<double> plan(n, -1, mode);
+    double planTime = omp_get_wtime() - t0;
+
+    cout << frames << " frames of " << n << " points on " << omp_get_max_threads() << " thread(s)\n";
+    cout << "Plan (" << (mode == PlanMode::Measure ? "measure" : "estimate") << "): " << strategyName(plan.strategy())
+         << ", " << isaName(plan.isa()) << ", built in " << planTime << " seconds\n";
+
+    vector<double> recursive(frames), rebuilt(frames), planned(frames);
+    double tRecursive = stream(n, frames, recursive, [n](vector<Complex>& in, vector<Complex>& out) {
+        fftRecursive(in, out, 0, n, 1);
+    });
+    double tRebuilt = stream(n, frames, rebuilt, [n](vector<Complex>& in, vector<Complex>& out) {
+        IterativeFFT<double> fresh(n);
+        out = in;
+        fresh(out);
+    });
+    double tPlanned = stream(n, frames, planned, [&plan](vector<Complex>& in, vector<Complex>& out) {
+        plan.execute(in, out);
+    });
+
+    // Same plan, one thread: concurrent execution must not change any result
+    vector<double> serial(frames);
+    int threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    stream(n, frames, serial, [&plan](vector<Complex>& in, vector<Complex>& out) { plan.execute(in, out); });
+    omp_set_num_threads(threads);
+
+    // Every sampleStep-th frame (64 to 127 of them, or all if fewer), spectrum by spectrum
+    const int sampleStep = max(1, frames / 64);
+    double maxDiff = 0.0;
+    #pragma omp parallel reduction(max : maxDiff)
+    {
+        vector<Complex> frame(n), reference(n), spectrum(n);
+        #pragma omp for schedule(dynamic)
+        for (int f = 0; f < frames; f += sampleStep) {
+            makeFrame(f, frame);
+            fftRecursive(frame, reference, 0, n, 1);
+            plan.execute(frame, spectrum);
+            maxDiff = max(maxDiff, relativeError(spectrum, reference));
+            IterativeFFT<double> fresh(n);
+            spectrum = frame;
+            fresh(spectrum);
+            maxDiff = max(maxDiff, relativeError(spectrum, reference));
+        }
+    }
+    bool sameAsSerial = planned == serial;
+
+    auto report = [frames](const char* name, double t) {
+        cout << name << t << " seconds (" << frames / t << " frames/s)\n";
+    };
+    report("Recursive fft() per frame : ", tRecursive);
+    report("New IterativeFFT per frame: ", tRebuilt);
+    report("Shared FftPlan            : ", tPlanned);
+    cout << "Max relative spectrum difference vs recursive (" << (frames + sampleStep - 1) / sampleStep
+         << " frames): " << maxDiff << "\n";
+    cout << "Threaded plan results identical to one thread: " << (sameAsSerial ? "yes" : "NO") << "\n";
+
+    return sameAsSerial && maxDiff < 1e-9 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <new>
+#include <cstddef>
+#include <algorithm>
+#include "FFT_radix.h"
+#include "FFT_simd.h"
+
+// Plan-based FFT, in the spirit of FFTW: everything that depends only on
+// (size, direction, precision) is done once, when the plan is built, and then
+// reused by every execute() call.
+//
+// A plan holds
+//   - the bit-reversal permutation and per-pass twiddles of both FFT_radix.h
+//     (interleaved std::complex) and FFT_simd.h (split re/im) transforms
+//   - the chosen strategy: with PlanMode::Estimate a fixed rule, with
+//     PlanMode::Measure the faster of the two timed on this machine at plan time
+//   - a pool of 64-byte aligned scratch buffers for the split strategy
+//
+// execute() never writes to the plan's tables. A call takes a scratch buffer out
+// of the pool (allocating one only when all are in use) and returns it at the
+// end, so many threads can execute the same plan at once on different arrays;
+// the pool grows to the number of concurrent callers and is then reused.
+
+enum class PlanMode { Estimate, Measure };
+enum class FftStrategy { Interleaved, Split };
+
+inline const char* strategyName(FftStrategy s) {
+    return s == FftStrategy::Split ? "split SIMD" : "interleaved radix-4";
+}
+
+template <typename T>
+class FftPlan {
+public:
+    using Complex = std::complex<T>;
+
+    FftPlan(size_t n, int direction = -1, PlanMode mode = PlanMode::Estimate)
+        : n_(n), direction_(direction), interleaved_(n, direction), split_(n, direction) {
+        // Split pays for (de)interleaving, which only the vector passes win back
+        strategy_ = split_.isa() != SimdIsa::Scalar && n >= 64 ? FftStrategy::Split : FftStrategy::Interleaved;
+        if (mode == PlanMode::Measure) strategy_ = measure();
+    }
+
+    FftPlan(const FftPlan&) = delete;
+    FftPlan& operator=(const FftPlan&) = delete;
+
+    size_t size() const { return n_; }
+    int direction() const { return direction_; }
+    FftStrategy strategy() const { return strategy_; }
+    SimdIsa isa() const { return split_.isa(); }
+
+    // out = DFT(in), unnormalised; in == out is allowed
+    void execute(const Complex* in, Complex* out) const { run(strategy_, in, out); }
+
+    void execute(const std::vector<Complex>& in, std::vector<Complex>& out) const { execute(in.data(), out.data()); }
+
+    // Same transform with a given strategy (for comparisons)
+    void executeWith(FftStrategy strategy, const Complex* in, Complex* out) const { run(strategy, in, out); }
+
+private:
+    struct FreeDeleter {
+        void operator()(T* p) const { std::free(p); }
+    };
+    using Buffer = std::unique_ptr<T, FreeDeleter>;
+
+    size_t n_;
+    int direction_;
+    FftStrategy strategy_;
+    IterativeFFT<T> interleaved_;
+    SplitFFT<T> split_;
+    mutable std::mutex poolMutex_;
+    mutable std::vector<Buffer> pool_;
+
+    // 2n values: re[0..n) then im[0..n)
+    Buffer acquire() const {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex_);
+            if (!pool_.empty()) {
+                Buffer b = std::move(pool_.back());
+                pool_.pop_back();
+                return b;
+            }
+        }
+        size_t bytes = (2 * n_ * sizeof(T) + 63) / 64 * 64;
+        T* p = static_cast<T*>(std::aligned_alloc(64, bytes));
+        if (!p) throw std::bad_alloc();
+        return Buffer(p);
+    }
+
+    void release(Buffer b) const {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        pool_.push_back(std::move(b));
+    }
+
+    void run(FftStrategy strategy, const Complex* in, Complex* out) const {
+        if (strategy == FftStrategy::Interleaved) {
+            if (in != out) std::copy(in, in + n_, out);
+            interleaved_(out);
+            return;
+        }
+
+        Buffer scratch = acquire();
+        T* re = scratch.get();
+        T* im = re + n_;
+        for (size_t i = 0; i < n_; ++i) {
+            re[i] = in[i].real();
+            im[i] = in[i].imag();
+        }
+        split_(re, im);
+        for (size_t i = 0; i < n_; ++i) out[i] = Complex(re[i], im[i]);
+        release(std::move(scratch));
+    }
+
+    // Times both strategies on random data and keeps the faster one
+    FftStrategy measure() const {
+        std::vector<Complex> data(n_), out(n_);
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<T> dist(-1, 1);
+        for (auto& x : data) x = Complex(dist(gen), dist(gen));
+
+        // Enough repetitions to transform about 2^20 points, at least 3
+        int reps = std::max<size_t>(3, (size_t(1) << 20) / n_);
+        double best = 0.0;
+        FftStrategy choice = strategy_;
+        for (FftStrategy s : {FftStrategy::Interleaved, FftStrategy::Split}) {
+            run(s, data.data(), out.data());  // warm up (and fill the scratch pool)
+            auto t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r < reps; ++r) run(s, data.data(), out.data());
+            double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            if (s == FftStrategy::Interleaved || t < best) {
+                best = t;
+                choice = s;
+            }
+        }
+        return choice;
+    }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+
+// Iterative in-place FFT for power-of-two sizes.
+//
+// The recursive fft() in FFT.cpp / FFT_seq.cpp allocates an even and an odd
+// vector at every level and calls cos/sin for every butterfly. Here the input is
+// permuted into bit-reversed order once and then combined in place, two radix-2
+// levels at a time with radix-4 butterflies (one radix-2 pass first when log2 n
+// is odd). The bit-reversal table and the twiddles of every pass are computed
+// when the object is built and stored in the order the passes read them, so a
+// transform does no trigonometry and no allocation.
+//
+// Direction -1 is the forward transform (the sign used by omega() in FFT.cpp),
+// +1 the inverse. Neither direction is normalised.
+
+template <typename T>
+class IterativeFFT {
+public:
+    using Complex = std::complex<T>;
+
+    explicit IterativeFFT(size_t n, int direction = -1) : n_(n), direction_(direction) {
+        if (n == 0 || (n & (n - 1)) != 0) throw std::invalid_argument("IterativeFFT: size must be a power of two");
+        if (direction != -1 && direction != 1) throw std::invalid_argument("IterativeFFT: direction must be -1 or +1");
+
+        int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        bitrev_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitrev_[i] = r;
+        }
+
+        // Radix-4 pass combining four DFTs of size m needs w^k, w^2k, w^3k with w = e^(dir 2 pi i / 4m)
+        radix2First_ = bits % 2 == 1;
+        const double pi = std::acos(-1.0);
+        for (size_t m = radix2First_ ? 2 : 1; 4 * m <= n; m *= 4) {
+            for (size_t k = 0; k < m; ++k) {
+                for (int p = 1; p <= 3; ++p) {
+                    double angle = direction * 2.0 * pi * static_cast<double>(p * k) / static_cast<double>(4 * m);
+                    twiddles_.push_back(Complex(static_cast<T>(std::cos(angle)), static_cast<T>(std::sin(angle))));
+                }
+            }
+        }
+    }
+
+    size_t size() const { return n_; }
+    int direction() const { return direction_; }
+
+    // Transforms data[0 .. n) in place; only reads the tables, so one object can
+    // be used from several threads on different arrays at once
+    void operator()(Complex* data) const {
+        permute(data);
+        if (radix2First_) radix2Pass(data);
+        const Complex* w = twiddles_.data();
+        for (size_t m = radix2First_ ? 2 : 1; 4 * m <= n_; m *= 4) {
+            radix4Pass(data, m, w);
+            w += 3 * m;
+        }
+    }
+
+    void operator()(std::vector<Complex>& data) const { (*this)(data.data()); }
+
+private:
+    size_t n_;
+    int direction_;
+    bool radix2First_ = false;
+    std::vector<uint32_t> bitrev_;
+    std::vector<Complex> twiddles_;
+
+    // Plain complex product; std::complex operator* adds NaN/inf recovery calls
+    static Complex mul(const Complex& a, const Complex& b) {
+        return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+
+    void permute(Complex* data) const {
+        for (size_t i = 0; i < n_; ++i) {
+            size_t r = bitrev_[i];
+            if (i < r) std::swap(data[i], data[r]);
+        }
+    }
+
+    void radix2Pass(Complex* data) const {
+        for (size_t i = 0; i < n_; i += 2) {
+            Complex a = data[i], b = data[i + 1];
+            data[i] = a + b;
+            data[i + 1] = a - b;
+        }
+    }
+
+    // In bit-reversed order the four quarters of a block of 4m hold the DFTs of
+    // x[4t], x[4t+2], x[4t+1], x[4t+3], so output k + jm is
+    //   Q0 + w^2k Q1 + w^k Q2 + w^3k Q3, with w^m = dir * i
+    void radix4Pass(Complex* data, size_t m, const Complex* w) const {
+        for (size_t base = 0; base < n_; base += 4 * m) {
+            Complex* x = data + base;
+            for (size_t k = 0; k < m; ++k) {
+                Complex a = x[k];
+                Complex b = mul(x[k + m], w[3 * k + 1]);
+                Complex c = mul(x[k + 2 * m], w[3 * k]);
+                Complex d = mul(x[k + 3 * m], w[3 * k + 2]);
+                Complex t0 = a + b, t1 = a - b, t2 = c + d, cd = c - d;
+                // (c - d) * dir * i
+                Complex t3 = direction_ < 0 ? Complex(cd.imag(), -cd.real()) : Complex(-cd.imag(), cd.real());
+                x[k] = t0 + t2;
+                x[k + m] = t1 + t3;
+                x[k + 2 * m] = t0 - t2;
+                x[k + 3 * m] = t1 - t3;
+            }
+        }
+    }
+};
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include "FFT_mixed.h"
+#include "FFT_radix.h"
+#include "FFT_reference.h"
+
+// Real-input and arbitrary-length FFTs (FFT_mixed.h).
+//
+// "check" compares MixedFFT with a direct O(n^2) DFT for every n up to 64 and a
+// set of larger smooth, prime and awkward lengths, and RealFFT with the complex
+// transform of the same samples plus its inverse round trip.
+//
+// Without arguments it times the FFT_seq.cpp case, 2^20 real samples: the
+// recursive complex fft() as FFT_seq.cpp runs it, the iterative complex
+// transform, and RealFFT on the same data as n real values; then lengths that are
+// not powers of two, against padding to the next power of two.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+vector<Complex> directDft(const vector<Complex>& x) {
+    size_t n = x.size();
+    const long double pi = acosl(-1.0L);
+    vector<Complex> out(n);
+    for (size_t k = 0; k < n; ++k) {
+        complex<long double> sum = 0;
+        for (size_t j = 0; j < n; ++j) {
+            long double angle = -2.0L * pi * static_cast<long double>(j * k % n) / n;
+            sum += complex<long double>(x[j].real(), x[j].imag()) * complex<long double>(cosl(angle), sinl(angle));
+        }
+        out[k] = Complex(static_cast<double>(sum.real()), static_cast<double>(sum.imag()));
+    }
+    return out;
+}
+
+double relativeError(const Complex* x, const Complex* y, size_t n) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        err = max(err, abs(x[i] - y[i]));
+        scale = max(scale, abs(y[i]));
+    }
+    return scale > 0.0 ? err / scale : err;
+}
+
+bool check() {
+    mt19937_64 gen(42);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    vector<size_t> sizes;
+    for (size_t n = 1; n <= 64; ++n) sizes.push_back(n);
+    for (size_t n : {96, 100, 210, 243, 343, 625, 720, 1000, 1009, 1024, 2310, 4096, 4099}) sizes.push_back(n);
+
+    double worstComplex = 0.0, worstReal = 0.0, worstRound = 0.0;
+    for (size_t n : sizes) {
+        vector<Complex> x(n);
+        vector<double> real(n);
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = Complex(dist(gen), dist(gen));
+            real[i] = x[i].real();
+        }
+
+        vector<Complex> expected = directDft(x), result(n);
+        MixedFFT<double> mixed(n);
+        mixed(x.data(), result.data());
+        worstComplex = max(worstComplex, relativeError(result.data(), expected.data(), n));
+
+        vector<Complex> realAsComplex(n), spectrum(n / 2 + 1);
+        for (size_t i = 0; i < n; ++i) realAsComplex[i] = Complex(real[i], 0);
+        expected = directDft(realAsComplex);
+        RealFFT<double> rfft(n);
+        rfft.forward(real.data(), spectrum.data());
+        worstReal = max(worstReal, relativeError(spectrum.data(), expected.data(), n / 2 + 1));
+
+        vector<double> back(n);
+        rfft.inverse(spectrum.data(), back.data());
+        for (size_t i = 0; i < n; ++i) worstRound = max(worstRound, abs(back[i] / n - real[i]));
+    }
+
+    bool ok = worstComplex < 1e-12 && worstReal < 1e-12 && worstRound < 1e-12;
+    cout << sizes.size() << " lengths from 1 to " << sizes.back() << " against a direct DFT\n";
+    cout << "MixedFFT max relative error       : " << worstComplex << "\n";
+    cout << "RealFFT max relative error        : " << worstReal << "\n";
+    cout << "RealFFT inverse round trip error  : " << worstRound << "\n";
+    cout << (ok ? "All checks passed" : "CHECK FAILED") << "\n";
+    return ok;
+}
+
+// Best of three runs, after one untimed run to fault in the buffers
+template <typename F>
+double seconds(F fn) {
+    fn();
+    double best = 1e30;
+    for (int r = 0; r < 3; ++r) {
+        auto t0 = chrono::high_resolution_clock::now();
+        fn();
+        best = min(best, chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count());
+    }
+    return best;
+}
+
+// Usage: ./cpp_FFT_real          timings
+//        ./cpp_FFT_real check    accuracy against a direct DFT
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "check") return check() ? 0 : 1;
+
+    const int n = 1 << 20;
+    vector<double> real(n, 1.0);  // the FFT_seq.cpp input, all values 1
+    vector<Complex> input(n, 1), output(n);
+
+    cout << "2^20 real samples (all ones, as in FFT_seq.cpp)\n";
+    cout << "Recursive complex fft()  : " << seconds([&] { fftRecursive(input, output, 0, n, 1); }) << " seconds\n";
+    IterativeFFT<double> iterative(n);
+    vector<Complex> data(n);
+    cout << "Iterative complex FFT    : " << seconds([&] {
+        data = input;
+        iterative(data);
+    }) << " seconds\n";
+    RealFFT<double> rfft(n);
+    vector<Complex> spectrum(rfft.bins()), rwork(rfft.workspaceSize());
+    cout << "RealFFT (n/2 complex)    : " << seconds([&] { rfft.forward(real.data(), spectrum.data(), rwork.data()); })
+         << " seconds, max difference " << relativeError(spectrum.data(), data.data(), rfft.bins()) << "\n";
+
+    cout << "\nLengths that are not powers of two (complex input)\n";
+    mt19937_64 gen(7);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (size_t len : {1000000, 1 << 20, 3 * (1 << 18), 44100 * 10, 1000003}) {
+        size_t padded = 1;
+        while (padded < len) padded *= 2;
+        vector<Complex> x(padded, Complex(0));
+        for (size_t i = 0; i < len; ++i) x[i] = Complex(dist(gen), dist(gen));
+        MixedFFT<double> exact(len);
+        IterativeFFT<double> pow2(padded);
+        vector<Complex> out(len), work(exact.workspaceSize());
+        double tExact = seconds([&] { exact(x.data(), out.data(), work.data()); });
+        vector<Complex> y(padded);
+        double tPadded = seconds([&] {
+            y = x;
+            pow2(y.data());
+        });
+        cout << "n = " << len << (exact.usesBluestein() ? " (Bluestein)" : "") << ": exact length " << tExact
+             << " seconds, padded to " << padded << " " << tPadded << " seconds\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <complex>
+#include <cmath>
+
+// The recursive fft() of FFT_seq.cpp and FFT.cpp, kept as references for the
+// accuracy checks and benchmarks of the other C++ FFT programs.
+
+using RefComplex = std::complex<double>;
+
+inline RefComplex referenceOmega(int k, int n) {
+    double angle = -2.0 * std::acos(-1.0) * k / n;
+    return RefComplex(std::cos(angle), std::sin(angle));
+}
+
+// FFT_seq.cpp
+inline void fftRecursive(std::vector<RefComplex>& a, std::vector<RefComplex>& out, int start, int n, int step) {
+    if (n == 1) {
+        out[start / step] = a[start];
+        return;
+    }
+
+    int half = n / 2;
+    std::vector<RefComplex> even(half), odd(half);
+
+    fftRecursive(a, even, start, half, 2 * step);
+    fftRecursive(a, odd, start + step, half, 2 * step);
+
+    for (int k = 0; k < half; ++k) {
+        RefComplex w = referenceOmega(k, n) * odd[k];
+        out[k] = even[k] + w;
+        out[k + half] = even[k] - w;
+    }
+}
+
+// FFT.cpp: OpenMP tasks above 2048 points; call from inside a parallel/single region
+inline void fftRecursiveTasks(std::vector<RefComplex>& a, std::vector<RefComplex>& out, int start, int n, int step) {
+    if (n == 1) {
+        out[start / step] = a[start];
+        return;
+    }
+
+    int half = n / 2;
+    std::vector<RefComplex> even(half), odd(half);
+
+    if (n > 2048) {
+        #pragma omp task shared(a, even, odd)
+        fftRecursiveTasks(a, even, start, half, 2 * step);
+
+        #pragma omp task shared(a, even, odd)
+        fftRecursiveTasks(a, odd, start + step, half, 2 * step);
+
+        #pragma omp taskwait
+    } else {
+        fftRecursiveTasks(a, even, start, half, 2 * step);
+        fftRecursiveTasks(a, odd, start + step, half, 2 * step);
+    }
+
+    for (int k = 0; k < half; ++k) {
+        RefComplex w = referenceOmega(k, n) * odd[k];
+        out[k] = even[k] + w;
+        out[k + half] = even[k] - w;
+    }
+}
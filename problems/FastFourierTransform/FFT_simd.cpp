@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <omp.h>
+#include "FFT_radix.h"
+#include "FFT_reference.h"
+#include "FFT_simd.h"
+
+// Benchmark of the split-complex SIMD FFT (FFT_simd.h) against the recursive
+// fft() of FFT_seq.cpp and FFT.cpp and the iterative FFT_radix.h, in GFLOP/s
+// (5 n log2 n / time, the usual FFT operation count), for sizes 2^minLog to
+// 2^maxLog. Every split variant is also compared with the iterative double
+// result so a fast but wrong kernel shows up in the table.
+
+using Complex = std::complex<double>;
+using namespace std;
+
+// Times fn over several runs (at least 3, at least ~0.2 s); setup runs before
+// each run outside the timed region. Returns seconds per run.
+double timeRuns(const function<void()>& setup, const function<void()>& fn) {
+    double total = 0.0;
+    int runs = 0;
+    while (runs < 3 || total < 0.2) {
+        setup();
+        auto t0 = chrono::high_resolution_clock::now();
+        fn();
+        auto t1 = chrono::high_resolution_clock::now();
+        total += chrono::duration<double>(t1 - t0).count();
+        ++runs;
+        if (total > 5.0) break;  // the recursive versions at the largest sizes
+    }
+    return total / runs;
+}
+
+template <typename T>
+double splitError(const vector<T>& re, const vector<T>& im, const vector<Complex>& reference) {
+    double err = 0.0, scale = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        err = max(err, abs(Complex(re[i], im[i]) - reference[i]));
+        scale = max(scale, abs(reference[i]));
+    }
+    return err / scale;
+}
+
+// Usage: ./cpp_FFT_simd [minLog maxLog]   (default 10 26)
+int main(int argc, char* argv[]) {
+    int minLog = argc > 2 ? stoi(argv[1]) : 10;
+    int maxLog = argc > 2 ? stoi(argv[2]) : 26;
+
+    vector<SimdIsa> isas;
+    for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512}) {
+        if (isaSupported(isa)) isas.push_back(isa);
+    }
+
+    cout << "GFLOP/s (5 n log2 n / t), " << omp_get_max_threads() << " thread(s) for FFT.cpp tasks; "
+         << "runtime dispatch picks " << isaName(detectIsa()) << "\n";
+    cout << setw(6) << "log2n" << setw(11) << "seq" << setw(11) << "tasks" << setw(11) << "iter";
+    for (const char* precision : {"d", "f"}) {
+        for (SimdIsa isa : isas) cout << setw(11) << (string(precision) + "-" + isaName(isa));
+    }
+    cout << "   max error (double / float)\n" << fixed;
+
+    mt19937_64 gen(42);
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+
+    for (int lg = minLog; lg <= maxLog; ++lg) {
+        int n = 1 << lg;
+        double flops = 5.0 * n * lg;
+        vector<Complex> input(n);
+        for (auto& x : input) x = Complex(dist(gen), dist(gen));
+        cout << setw(6) << lg << setprecision(2);
+
+        {
+            vector<Complex> out(n);
+            double t = timeRuns([] {}, [&] { fftRecursive(input, out, 0, n, 1); });
+            cout << setw(11) << flops / t * 1e-9;
+        }
+        {
+            vector<Complex> out(n);
+            double t = timeRuns([] {}, [&] {
+                #pragma omp parallel
+                {
+                    #pragma omp single
+                    fftRecursiveTasks(input, out, 0, n, 1);
+                }
+            });
+            cout << setw(11) << flops / t * 1e-9;
+        }
+
+        vector<Complex> reference(n);
+        {
+            IterativeFFT<double> plan(n);
+            double t = timeRuns([&] { reference = input; }, [&] { plan(reference); });
+            cout << setw(11) << flops / t * 1e-9;
+        }
+
+        double worstDouble = 0.0, worstFloat = 0.0;
+        {
+            vector<double> re(n), im(n);
+            for (SimdIsa isa : isas) {
+                SplitFFT<double> plan(n, -1, isa);
+                auto setup = [&] {
+                    for (int i = 0; i < n; ++i) re[i] = input[i].real(), im[i] = input[i].imag();
+                };
+                double t = timeRuns(setup, [&] { plan(re, im); });
+                worstDouble = max(worstDouble, splitError(re, im, reference));
+                cout << setw(11) << flops / t * 1e-9;
+            }
+        }
+        {
+            vector<float> re(n), im(n);
+            for (SimdIsa isa : isas) {
+                SplitFFT<float> plan(n, -1, isa);
+                auto setup = [&] {
+                    for (int i = 0; i < n; ++i) re[i] = input[i].real(), im[i] = input[i].imag();
+                };
+                double t = timeRuns(setup, [&] { plan(re, im); });
+                worstFloat = max(worstFloat, splitError(re, im, reference));
+                cout << setw(11) << flops / t * 1e-9;
+            }
+        }
+        cout << scientific << setprecision(1) << "   " << worstDouble << " / " << worstFloat << fixed << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <stdexcept>
+#include <utility>
+
+// Split-complex (structure of arrays) FFT with SIMD butterflies.
+//
+// std::complex<double> arrays interleave real and imaginary parts, so a vector
+// register holding consecutive elements mixes the two and every complex multiply
+// needs shuffles. Keeping re[] and im[] in separate arrays lets one register hold
+// the real parts of W consecutive butterflies and another their imaginary parts;
+// the radix-4 butterfly of FFT_radix.h then becomes plain vertical adds,
+// subtracts and multiplies.
+//
+// The algorithm is the same as IterativeFFT: bit-reversal permutation, then
+// radix-4 passes (one radix-2 pass first for odd log2 n). A pass over blocks of
+// 4m runs W butterflies at a time once m >= W, where W is 4/8 doubles or 8/16
+// floats for AVX2/AVX-512; the first, short passes stay scalar. The kernel is
+// written once with GCC vector extensions and instantiated inside functions
+// compiled for each instruction set, and the instruction set is picked at run
+// time from the CPU (or the FFT_ISA environment variable: scalar, avx2, avx512).
+
+enum class SimdIsa { Scalar, Avx2, Avx512 };
+
+inline const char* isaName(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::Avx512: return "avx512";
+        case SimdIsa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+inline bool isaSupported(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::Avx512: return __builtin_cpu_supports("avx512f");
+        case SimdIsa::Avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        default: return true;
+    }
+}
+
+// Best instruction set of this CPU, unless FFT_ISA asks for a (supported) other one
+inline SimdIsa detectIsa() {
+    if (const char* env = std::getenv("FFT_ISA")) {
+        std::string name = env;
+        for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512}) {
+            if (name == isaName(isa) && isaSupported(isa)) return isa;
+        }
+    }
+    if (isaSupported(SimdIsa::Avx512)) return SimdIsa::Avx512;
+    if (isaSupported(SimdIsa::Avx2)) return SimdIsa::Avx2;
+    return SimdIsa::Scalar;
+}
+
+namespace simd_detail {
+
+// W lanes of T; only element alignment is assumed, so any T* can be viewed as V*
+template <typename T, int W>
+struct VecType {
+    typedef T type __attribute__((vector_size(sizeof(T) * W), aligned(sizeof(T)), may_alias));
+};
+
+template <typename T>
+struct VecType<T, 1> {
+    typedef T type;
+};
+
+// Radix-4 pass over blocks of 4m, W butterflies at a time (m % W == 0).
+// tw holds w^k, w^2k, w^3k for k < m as six arrays: w1re, w1im, w2re, w2im, w3re, w3im.
+// Only the first 'span' butterflies of each block are done; shifting re, im and
+// tw by k0 together with span < m runs the slice k0 .. k0 + span of a block.
+template <typename T, int W>
+__attribute__((always_inline)) inline void radix4Pass(T* re, T* im, size_t n, size_t m, const T* tw, int direction,
+                                                      size_t span) {
+    typedef typename VecType<T, W>::type V;
+    const size_t mv = m / W;
+    const size_t sv = span / W;
+    const V* w = reinterpret_cast<const V*>(tw);
+
+    for (size_t base = 0; base < n; base += 4 * m) {
+        V* xr = reinterpret_cast<V*>(re + base);
+        V* xi = reinterpret_cast<V*>(im + base);
+        for (size_t k = 0; k < sv; ++k) {
+            V w1r = w[k], w1i = w[mv + k];
+            V w2r = w[2 * mv + k], w2i = w[3 * mv + k];
+            V w3r = w[4 * mv + k], w3i = w[5 * mv + k];
+
+            V ar = xr[k], ai = xi[k];
+            V q1r = xr[k + mv], q1i = xi[k + mv];
+            V q2r = xr[k + 2 * mv], q2i = xi[k + 2 * mv];
+            V q3r = xr[k + 3 * mv], q3i = xi[k + 3 * mv];
+
+            V br = q1r * w2r - q1i * w2i, bi = q1r * w2i + q1i * w2r;
+            V cr = q2r * w1r - q2i * w1i, ci = q2r * w1i + q2i * w1r;
+            V dr = q3r * w3r - q3i * w3i, di = q3r * w3i + q3i * w3r;
+
+            V t0r = ar + br, t0i = ai + bi;
+            V t1r = ar - br, t1i = ai - bi;
+            V t2r = cr + dr, t2i = ci + di;
+            // (c - d) * direction * i
+            V t3r = direction < 0 ? ci - di : di - ci;
+            V t3i = direction < 0 ? dr - cr : cr - dr;
+
+            xr[k] = t0r + t2r;
+            xi[k] = t0i + t2i;
+            xr[k + mv] = t1r + t3r;
+            xi[k + mv] = t1i + t3i;
+            xr[k + 2 * mv] = t0r - t2r;
+            xi[k + 2 * mv] = t0i - t2i;
+            xr[k + 3 * mv] = t1r - t3r;
+            xi[k + 3 * mv] = t1i - t3i;
+        }
+    }
+}
+
+template <typename T>
+void radix4Scalar(T* re, T* im, size_t n, size_t m, const T* tw, int direction, size_t span) {
+    radix4Pass<T, 1>(re, im, n, m, tw, direction, span);
+}
+
+__attribute__((target("avx2,fma"))) inline void radix4Avx2(double* re, double* im, size_t n, size_t m,
+                                                           const double* tw, int direction, size_t span) {
+    radix4Pass<double, 4>(re, im, n, m, tw, direction, span);
+}
+
+__attribute__((target("avx2,fma"))) inline void radix4Avx2(float* re, float* im, size_t n, size_t m,
+                                                           const float* tw, int direction, size_t span) {
+    radix4Pass<float, 8>(re, im, n, m, tw, direction, span);
+}
+
+__attribute__((target("avx512f"))) inline void radix4Avx512(double* re, double* im, size_t n, size_t m,
+                                                             const double* tw, int direction, size_t span) {
+    radix4Pass<double, 8>(re, im, n, m, tw, direction, span);
+}
+
+__attribute__((target("avx512f"))) inline void radix4Avx512(float* re, float* im, size_t n, size_t m,
+                                                             const float* tw, int direction, size_t span) {
+    radix4Pass<float, 16>(re, im, n, m, tw, direction, span);
+}
+
+}  // namespace simd_detail
+
+template <typename T>
+class SplitFFT {
+public:
+    explicit SplitFFT(size_t n, int direction = -1, SimdIsa isa = detectIsa())
+        : n_(n), direction_(direction), isa_(isaSupported(isa) ? isa : SimdIsa::Scalar) {
+        if (n == 0 || (n & (n - 1)) != 0) throw std::invalid_argument("SplitFFT: size must be a power of two");
+        if (direction != -1 && direction != 1) throw std::invalid_argument("SplitFFT: direction must be -1 or +1");
+
+        int bits = 0;
+        while ((size_t(1) << bits) < n) ++bits;
+        bitrev_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitrev_[i] = r;
+        }
+
+        radix2First_ = bits % 2 == 1;
+        const double pi = std::acos(-1.0);
+        for (size_t m = radix2First_ ? 2 : 1; 4 * m <= n; m *= 4) {
+            size_t at = twiddles_.size();
+            twiddles_.resize(at + 6 * m);
+            for (size_t k = 0; k < m; ++k) {
+                for (int p = 1; p <= 3; ++p) {
+                    double angle = direction * 2.0 * pi * static_cast<double>(p * k) / static_cast<double>(4 * m);
+                    twiddles_[at + (2 * p - 2) * m + k] = static_cast<T>(std::cos(angle));
+                    twiddles_[at + (2 * p - 1) * m + k] = static_cast<T>(std::sin(angle));
+                }
+            }
+        }
+    }
+
+    size_t size() const { return n_; }
+    int direction() const { return direction_; }
+    SimdIsa isa() const { return isa_; }
+
+    // Tables for kernels with other layouts (FFT_batch.h): the bit-reversal
+    // permutation, whether a radix-2 pass comes first, and the per-pass twiddles
+    const uint32_t* bitReversal() const { return bitrev_.data(); }
+    bool radix2First() const { return radix2First_; }
+    const T* twiddles() const { return twiddles_.data(); }
+
+    // Transforms (re[i], im[i]), i < n, in place; read-only on the object
+    void operator()(T* re, T* im) const {
+        for (size_t i = 0; i < n_; ++i) {
+            size_t r = bitrev_[i];
+            if (i < r) {
+                std::swap(re[i], re[r]);
+                std::swap(im[i], im[r]);
+            }
+        }
+        if (radix2First_) {
+            for (size_t i = 0; i < n_; i += 2) {
+                T ar = re[i], ai = im[i];
+                re[i] = ar + re[i + 1];
+                im[i] = ai + im[i + 1];
+                re[i + 1] = ar - re[i + 1];
+                im[i + 1] = ai - im[i + 1];
+            }
+        }
+
+        const T* tw = twiddles_.data();
+        for (size_t m = radix2First_ ? 2 : 1; 4 * m <= n_; m *= 4) {
+            pass(re, im, n_, m, tw, m);
+            tw += 6 * m;
+        }
+    }
+
+    // The same transform with every step shared by the OpenMP threads, for one
+    // transform too large for a core. Passes with many blocks hand out whole
+    // blocks; the last passes, with few large blocks, hand out slices of each
+    // block's butterflies. Call it outside a parallel region.
+    void parallel(T* re, T* im) const {
+        const size_t width = lanes();
+        #pragma omp parallel
+        {
+            #pragma omp for schedule(static)
+            for (size_t i = 0; i < n_; ++i) {
+                size_t r = bitrev_[i];
+                if (i < r) {
+                    std::swap(re[i], re[r]);
+                    std::swap(im[i], im[r]);
+                }
+            }
+            if (radix2First_) {
+                #pragma omp for schedule(static)
+                for (size_t i = 0; i < n_; i += 2) {
+                    T ar = re[i], ai = im[i];
+                    re[i] = ar + re[i + 1];
+                    im[i] = ai + im[i + 1];
+                    re[i + 1] = ar - re[i + 1];
+                    im[i + 1] = ai - im[i + 1];
+                }
+            }
+
+            const T* tw = twiddles_.data();
+            for (size_t m = radix2First_ ? 2 : 1; 4 * m <= n_; m *= 4) {
+                size_t blocks = n_ / (4 * m);
+                size_t span = m;
+                while (blocks * (m / span) < 64 && span >= 2 * width && span >= 128) span /= 2;
+                size_t pieces = blocks * (m / span);
+
+                #pragma omp for schedule(static)
+                for (size_t p = 0; p < pieces; ++p) {
+                    size_t block = p / (m / span), k0 = (p % (m / span)) * span;
+                    size_t base = block * 4 * m + k0;
+                    pass(re + base, im + base, 4 * m, m, tw + k0, span);
+                }
+                tw += 6 * m;
+            }
+        }
+    }
+
+    void operator()(std::vector<T>& re, std::vector<T>& im) const { (*this)(re.data(), im.data()); }
+
+private:
+    size_t n_;
+    int direction_;
+    SimdIsa isa_;
+    bool radix2First_ = false;
+    std::vector<uint32_t> bitrev_;
+    std::vector<T> twiddles_;
+
+    void pass(T* re, T* im, size_t n, size_t m, const T* tw, size_t span) const {
+        if (span < lanes() || isa_ == SimdIsa::Scalar) {
+            simd_detail::radix4Scalar(re, im, n, m, tw, direction_, span);
+        } else if (isa_ == SimdIsa::Avx512) {
+            simd_detail::radix4Avx512(re, im, n, m, tw, direction_, span);
+        } else {
+            simd_detail::radix4Avx2(re, im, n, m, tw, direction_, span);
+        }
+    }
+
+    // Elements of T per vector register
+    size_t lanes() const {
+        size_t bytes = isa_ == SimdIsa::Avx512 ? 64 : isa_ == SimdIsa::Avx2 ? 32 : sizeof(T);
+        return bytes / sizeof(T);
+    }
+};
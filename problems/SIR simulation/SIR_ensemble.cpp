@@ -0,0 +1,216 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <map>
+#include <omp.h>
+#include "SIR_model.h"
+
+// Ensemble runner for the SIR model with movement (SIR_model.h).
+//
+// A sweep over (beta, gamma, density) times a number of replicates becomes a flat
+// list of work items, handed out to the OpenMP threads dynamically. Every thread
+// allocates its two Grids and proposal buffer once and reuses them for all of its
+// items. Instead of storing trajectories, each thread folds the infected and
+// recovered counts of every time step into running statistics per (parameter
+// set, step): Welford mean/variance plus exact counts per value for quantiles.
+// The per-thread statistics are merged at the end and written as one CSV row (or
+// binary float32 record) per (parameter set, step).
+//
+// Replicate r of parameter set p uses key (seed, p * replicates + r), so every
+// trajectory is reproducible on its own, independent of the scheduling.
+
+struct RunningStats {
+    uint64_t n = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    uint32_t lo = 0, hi = 0;             // observed range, valid once n > 0
+    std::map<uint32_t, uint64_t> counts;  // exact count per value; at most one entry per replicate
+
+    // x is a head count, a non-negative integer
+    void add(uint32_t x) {
+        lo = n == 0 ? x : std::min(lo, x);
+        hi = n == 0 ? x : std::max(hi, x);
+        n++;
+        double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+        counts[x]++;
+    }
+
+    // Chan et al. pairwise combination of two partial results
+    void merge(const RunningStats& other) {
+        if (other.n == 0) return;
+        lo = n == 0 ? other.lo : std::min(lo, other.lo);
+        hi = n == 0 ? other.hi : std::max(hi, other.hi);
+        uint64_t total = n + other.n;
+        double delta = other.mean - mean;
+        mean += delta * other.n / total;
+        m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+        n = total;
+        for (const auto& [value, count] : other.counts) counts[value] += count;
+    }
+
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+
+    // Linear interpolation between the order statistics around rank q (n - 1),
+    // kept inside the observed range
+    double quantile(double q) const {
+        if (n == 0) return 0.0;
+        double rank = q * (n - 1);
+        uint64_t below = static_cast<uint64_t>(rank);
+        double frac = rank - below, lower = hi, upper = hi;
+        uint64_t seen = 0;
+        for (auto it = counts.begin(); it != counts.end(); ++it) {
+            seen += it->second;
+            if (seen > below) {
+                lower = it->first;
+                // The next order statistic is the same value unless this one ends here
+                upper = seen > below + 1 || std::next(it) == counts.end() ? it->first : std::next(it)->first;
+                break;
+            }
+        }
+        return std::clamp(lower + frac * (upper - lower), static_cast<double>(lo), static_cast<double>(hi));
+    }
+};
+
+// A constant series must give that constant for every quantile, and a known
+// small series the textbook interpolated quantiles
+bool quantilesOk() {
+    RunningStats constant, ramp, left, right;
+    for (int i = 0; i < 100; ++i) constant.add(7);
+    for (uint32_t x : {1u, 2u, 3u, 4u, 5u}) {
+        ramp.add(x);
+        if (x % 2) left.add(x);
+        else right.add(x);
+    }
+    left.merge(right);
+    bool ok = true;
+    for (double q : {0.0, 0.05, 0.5, 0.95, 1.0}) ok = ok && constant.quantile(q) == 7.0;
+    for (const RunningStats* s : {&ramp, &left}) {
+        ok = ok && std::fabs(s->quantile(0.05) - 1.2) < 1e-12 && s->quantile(0.5) == 3.0 &&
+             std::fabs(s->quantile(0.95) - 4.8) < 1e-12;
+    }
+    return ok;
+}
+
+struct Params {
+    float beta, gamma, density;
+};
+
+// Usage: ./SIR_ensemble_cpp [replicates] [csv|bin] [seed]
+int main(int argc, char* argv[]) {
+    const int replicates = argc > 1 ? std::stoi(argv[1]) : 50;
+    const bool binary = argc > 2 && std::string(argv[2]) == "bin";
+    const uint64_t seed = argc > 3 ? std::stoull(argv[3]) : 42;
+    const int rows = 50;
+    const int cols = 50;
+    const int steps = 50;
+
+    if (!quantilesOk()) {
+        std::cerr << "RunningStats quantiles are wrong\n";
+        return 1;
+    }
+
+    std::vector<Params> sweep;
+    for (float beta : {0.1f, 0.2f, 0.3f}) {
+        for (float gamma : {0.05f, 0.1f, 0.2f}) {
+            for (float density : {0.5f, 0.7f, 0.9f}) sweep.push_back({beta, gamma, density});
+        }
+    }
+    const int numParams = sweep.size();
+    const long long numItems = static_cast<long long>(numParams) * replicates;
+    const size_t statsPerMetric = static_cast<size_t>(numParams) * (steps + 1);
+
+    int nthreads = omp_get_max_threads();
+    // [thread][metric][param * (steps + 1) + step], metric 0 = infected, 1 = recovered
+    std::vector<std::vector<RunningStats>> threadStats(nthreads, std::vector<RunningStats>(2 * statsPerMetric));
+
+    double t1 = omp_get_wtime();
+
+    #pragma omp parallel
+    {
+        auto& stats = threadStats[omp_get_thread_num()];
+        Grid pop(rows, cols), next(rows, cols);
+        std::vector<uint8_t> proposals;
+
+        auto record = [&](int p, int s) {
+            size_t at = static_cast<size_t>(p) * (steps + 1) + s;
+            stats[at].add(pop.countInfected());
+            stats[statsPerMetric + at].add(pop.countRecovered());
+        };
+
+        #pragma omp for schedule(dynamic, 4)
+        for (long long item = 0; item < numItems; ++item) {
+            int p = item / replicates;
+            const Params& params = sweep[p];
+            CounterRng rng((seed << 32) | static_cast<uint32_t>(item));
+
+            initializePopulation(pop, params.density, rng);
+            seedPatientZero(pop, rng);
+            record(p, 0);
+            for (int s = 0; s < steps; ++s) {
+                stepBitsliced(params.beta, params.gamma, pop, next, rng, s);
+                movePopulation(pop, next, proposals, rng, s);
+                record(p, s + 1);
+            }
+        }
+    }
+
+    for (int t = 1; t < nthreads; ++t) {
+        for (size_t k = 0; k < threadStats[0].size(); ++k) threadStats[0][k].merge(threadStats[t][k]);
+    }
+    const auto& stats = threadStats[0];
+
+    double t2 = omp_get_wtime();
+
+    // One row per (parameter set, step)
+    const char* columns = "beta,gamma,density,step,replicates,"
+                          "infected_mean,infected_sd,infected_p05,infected_p50,infected_p95,"
+                          "recovered_mean,recovered_sd,recovered_p05,recovered_p50,recovered_p95";
+    const int numColumns = 15;
+    std::string filename = binary ? "sir_ensemble.bin" : "sir_ensemble.csv";
+    std::ofstream out(filename, binary ? std::ios::binary : std::ios::out);
+    if (binary) {
+        // Header: "SIRE", rows, columns; then rows of float32 in the CSV column order
+        uint32_t header[2] = {static_cast<uint32_t>(statsPerMetric), numColumns};
+        out.write("SIRE", 4);
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    } else {
+        out << columns << "\n";
+    }
+
+    for (int p = 0; p < numParams; ++p) {
+        for (int s = 0; s <= steps; ++s) {
+            size_t at = static_cast<size_t>(p) * (steps + 1) + s;
+            const RunningStats& inf = stats[at];
+            const RunningStats& rec = stats[statsPerMetric + at];
+            float row[numColumns] = {
+                sweep[p].beta, sweep[p].gamma, sweep[p].density, static_cast<float>(s),
+                static_cast<float>(inf.n),
+                static_cast<float>(inf.mean), static_cast<float>(std::sqrt(inf.variance())),
+                static_cast<float>(inf.quantile(0.05)), static_cast<float>(inf.quantile(0.5)),
+                static_cast<float>(inf.quantile(0.95)),
+                static_cast<float>(rec.mean), static_cast<float>(std::sqrt(rec.variance())),
+                static_cast<float>(rec.quantile(0.05)), static_cast<float>(rec.quantile(0.5)),
+                static_cast<float>(rec.quantile(0.95))};
+            if (binary) {
+                out.write(reinterpret_cast<const char*>(row), sizeof(row));
+            } else {
+                for (int c = 0; c < numColumns; ++c) out << row[c] << (c + 1 == numColumns ? "\n" : ",");
+            }
+        }
+    }
+    out.close();
+
+    std::cout << numParams << " parameter sets x " << replicates << " replicates ("
+              << numItems << " simulations) on " << nthreads << " thread(s)\n";
+    std::cout << "Time taken: " << (t2 - t1) << " seconds ("
+              << numItems / (t2 - t1) << " simulations/s)\n";
+    std::cout << "Statistics written to " << filename << "\n";
+
+    return 0;
+}
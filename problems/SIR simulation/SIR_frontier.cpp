@@ -0,0 +1,164 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <omp.h>
+#include "SIR_grid.h"
+#include "SIR_model.h"
+#include "SIR_rng.h"
+
+// Frontier-driven SIR (simple model, no movement) on one large grid.
+//
+// A susceptible cell can only change if it has an infected neighbour, and only
+// infected cells can recover, so a step only has to look at the infected cells
+// and their Moore neighbourhoods. The frontier keeps the list of infected cells;
+// each step
+//   1. marks the susceptible neighbours of every infected cell (once each, via
+//      an atomic fetch-or on a candidate bitmap) and decides their infection
+//   2. decides recovery for every infected cell
+//   3. applies the changes and builds the next infected list
+// so the cost follows the size of the epidemic instead of the grid area.
+//
+// The dense sweep over the whole grid (stepBitsliced() from SIR_model.h) runs
+// on a copy of the same initial state; both use the same counter-based draws
+// per (step, cell), so the final states must agree exactly. Per-step times are
+// reported for the early and late part of the outbreak.
+
+struct Frontier {
+    std::vector<uint64_t> infected;    // cell indices (i * cols + j)
+    std::vector<uint64_t> candidates;  // bitmap, same layout as a Grid plane
+};
+
+// Sparse step touching only the infected cells and their neighbourhoods
+void stepFrontier(double beta, double gamma, Grid& pop, Frontier& frontier, const CounterRng& rng,
+                  uint32_t stepNum) {
+    double infectProb[9];
+    infectionTable(beta, infectProb);
+    int rows = pop.rows, cols = pop.cols;
+    const std::vector<uint64_t>& active = frontier.infected;
+    std::vector<uint64_t> newlyInfected, stillInfected, recovered;
+
+    #pragma omp parallel
+    {
+        std::vector<uint64_t> localInfected, localStill, localRecovered;
+
+        #pragma omp for schedule(static) nowait
+        for (size_t a = 0; a < active.size(); ++a) {
+            uint64_t cell = active[a];
+            int i = static_cast<int>(cell / cols), j = static_cast<int>(cell % cols);
+
+            for (int di = -1; di <= 1; ++di) {
+                for (int dj = -1; dj <= 1; ++dj) {
+                    int ni = i + di, nj = j + dj;
+                    if ((di == 0 && dj == 0) || ni < 0 || ni >= rows || nj < 0 || nj >= cols) continue;
+                    if (!pop.isOccupied(ni, nj) || pop.state(ni, nj) != State::Susceptible) continue;
+
+                    // The first infected neighbour to reach a candidate evaluates it
+                    size_t w = pop.word(ni, nj);
+                    uint64_t b = Grid::bit(nj);
+                    if (__atomic_fetch_or(&frontier.candidates[w], b, __ATOMIC_RELAXED) & b) continue;
+
+                    int count = 0;
+                    for (int ei = ni - 1; ei <= ni + 1; ++ei) {
+                        for (int ej = nj - 1; ej <= nj + 1; ++ej) {
+                            if (ei >= 0 && ei < rows && ej >= 0 && ej < cols && pop.isInfected(ei, ej)) ++count;
+                        }
+                    }
+                    uint64_t ncell = static_cast<uint64_t>(ni) * cols + nj;
+                    if (rng.uniform(stepNum, ncell) < infectProb[count]) localInfected.push_back(ncell);
+                }
+            }
+
+            if (rng.uniform(stepNum, cell) < gamma) localRecovered.push_back(cell);
+            else localStill.push_back(cell);
+        }
+
+        #pragma omp critical
+        {
+            newlyInfected.insert(newlyInfected.end(), localInfected.begin(), localInfected.end());
+            stillInfected.insert(stillInfected.end(), localStill.begin(), localStill.end());
+            recovered.insert(recovered.end(), localRecovered.begin(), localRecovered.end());
+        }
+    }
+
+    // Apply all decisions only after every cell has read the old state
+    for (uint64_t cell : recovered) pop.set(cell / cols, cell % cols, State::Recovered);
+    for (uint64_t cell : newlyInfected) pop.set(cell / cols, cell % cols, State::Infected);
+
+    // Candidates were only marked around the old frontier, so clear just those words
+    for (uint64_t cell : active) {
+        int i = cell / cols;
+        for (int r = std::max(0, i - 1); r <= std::min(rows - 1, i + 1); ++r) {
+            size_t w = pop.word(r, static_cast<int>(cell % cols));
+            frontier.candidates[w] = 0;
+            if (w % pop.words) frontier.candidates[w - 1] = 0;
+            if ((w + 1) % pop.words) frontier.candidates[w + 1] = 0;
+        }
+    }
+
+    stillInfected.insert(stillInfected.end(), newlyInfected.begin(), newlyInfected.end());
+    frontier.infected.swap(stillInfected);
+}
+
+// Usage: ./SIR_frontier_cpp [rows cols steps [seed]]
+int main(int argc, char* argv[]) {
+    const int rows = argc > 1 ? std::stoi(argv[1]) : 4000;
+    const int cols = argc > 2 ? std::stoi(argv[2]) : 4000;
+    const int steps = argc > 3 ? std::stoi(argv[3]) : 400;
+    const uint64_t seed = argc > 4 ? std::stoull(argv[4]) : 42;
+    const double beta = 0.2;
+    const double gamma = 0.1;
+    CounterRng rng(seed << 32);
+
+    Grid initial(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) initial.set(i, j, State::Susceptible);
+    }
+    initial.set(rows / 2, cols / 2, State::Infected);
+
+    Grid dense = initial, next(rows, cols);
+    Grid sparse = initial;
+    Frontier frontier;
+    frontier.infected.push_back(static_cast<uint64_t>(rows / 2) * cols + cols / 2);
+    frontier.candidates.assign(sparse.occupied.size(), 0);
+
+    std::vector<double> denseTimes(steps), frontierTimes(steps);
+    std::vector<size_t> frontierSizes(steps);
+    for (int s = 0; s < steps; ++s) {
+        double t0 = omp_get_wtime();
+        stepBitsliced(beta, gamma, dense, next, rng, s);
+        double t1 = omp_get_wtime();
+        frontierSizes[s] = frontier.infected.size();
+        stepFrontier(beta, gamma, sparse, frontier, rng, s);
+        double t2 = omp_get_wtime();
+        denseTimes[s] = t1 - t0;
+        frontierTimes[s] = t2 - t1;
+    }
+
+    bool same = dense.infected == sparse.infected && dense.recovered == sparse.recovered;
+    std::cout << "Grid " << rows << " x " << cols << ", " << steps << " steps, "
+              << omp_get_max_threads() << " thread(s)\n";
+    std::cout << "Infected at end of simulation: " << sparse.countInfected()
+              << " (dense and frontier agree: " << (same ? "yes" : "NO") << ")\n";
+
+    // Early = first quarter of the steps, late = last quarter
+    auto report = [&](const char* name, int begin, int end) {
+        double d = 0, f = 0;
+        size_t n = 0;
+        for (int s = begin; s < end; ++s) {
+            d += denseTimes[s];
+            f += frontierTimes[s];
+            n += frontierSizes[s];
+        }
+        int count = std::max(1, end - begin);
+        std::cout << name << " (steps " << begin << "-" << end - 1 << ", avg " << n / count
+                  << " infected): dense " << d / count << " s/step, frontier " << f / count
+                  << " s/step, speedup " << (f > 0 ? d / f : 0.0) << "x\n";
+    };
+    report("Early", 0, steps / 4);
+    report("Late ", steps - steps / 4, steps);
+    report("All  ", 0, steps);
+
+    return same ? 0 : 1;
+}
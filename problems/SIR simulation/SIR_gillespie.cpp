@@ -0,0 +1,232 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <omp.h>
+#include "SIR_model.h"
+
+// Event-driven (Gillespie direct method) continuous-time version of the SIR model
+// with movement from SIR_model.h.
+//
+// Each cell carries the total rate of the events that can happen to it:
+//   susceptible  infection at k * lambda, k = infected Moore neighbours
+//   infected     recovery at mu
+//   occupied     a move attempt at m (random direction, only into an empty cell)
+// The rates are chosen so that over one time unit the event probabilities match
+// one discrete step: 1 - (1 - beta)^k = 1 - exp(-k * lambda) gives
+// lambda = -ln(1 - beta), and likewise mu = -ln(1 - gamma), m = -ln(1 - moveProb).
+//
+// The rates live in a Fenwick (binary indexed) tree, so the next event is sampled
+// in O(log n) by a prefix-sum search, and an event only refreshes the rates of
+// the cells it touches and their neighbours. The work therefore follows the
+// number of events, not the number of cells times steps.
+//
+// The program runs the discrete simulate() loop and the event-driven engine from
+// the same initial populations and compares final infection statistics. The two
+// agree when the per-step probabilities are small; at larger beta the continuous
+// engine spreads faster, because a newly infected cell can pass the infection on
+// within the same time unit while the synchronous step makes it wait a step.
+
+struct Fenwick {
+    int n = 0;
+    std::vector<double> tree;  // 1-based
+
+    void build(const std::vector<double>& values) {
+        n = values.size();
+        tree.assign(n + 1, 0.0);
+        for (int i = 1; i <= n; ++i) {
+            tree[i] += values[i - 1];
+            int parent = i + (i & -i);
+            if (parent <= n) tree[parent] += tree[i];
+        }
+    }
+
+    void add(int index, double delta) {
+        for (int i = index + 1; i <= n; i += i & -i) tree[i] += delta;
+    }
+
+    // Index of the cell whose cumulative rate interval contains 'target'
+    int find(double target) const {
+        int pos = 0;
+        int mask = 1;
+        while (mask * 2 <= n) mask *= 2;
+        for (; mask; mask >>= 1) {
+            int next = pos + mask;
+            if (next <= n && tree[next] <= target) {
+                pos = next;
+                target -= tree[next];
+            }
+        }
+        return std::min(pos, n - 1);
+    }
+};
+
+struct GillespieSim {
+    Grid pop;
+    double infectRate, recoverRate, moveRate;
+    std::vector<double> rate;
+    Fenwick tree;
+    double total = 0.0;
+    uint64_t events = 0;
+
+    GillespieSim(int rows, int cols, double beta, double gamma, double moveProb)
+        : pop(rows, cols), infectRate(-std::log(1.0 - beta)), recoverRate(-std::log(1.0 - gamma)),
+          moveRate(moveProb < 1.0 ? -std::log(1.0 - moveProb) : 0.0),
+          rate(static_cast<size_t>(rows) * cols, 0.0) {}
+
+    double cellRate(int i, int j) const {
+        if (!pop.isOccupied(i, j)) return 0.0;
+        switch (pop.state(i, j)) {
+            case State::Susceptible: {
+                int k = 0;
+                for (int ni = std::max(0, i - 1); ni <= std::min(pop.rows - 1, i + 1); ++ni) {
+                    for (int nj = std::max(0, j - 1); nj <= std::min(pop.cols - 1, j + 1); ++nj) {
+                        if (pop.isInfected(ni, nj)) ++k;
+                    }
+                }
+                return moveRate + k * infectRate;
+            }
+            case State::Infected: return moveRate + recoverRate;
+            default: return moveRate;
+        }
+    }
+
+    void refreshAround(int i, int j) {
+        for (int ni = std::max(0, i - 1); ni <= std::min(pop.rows - 1, i + 1); ++ni) {
+            for (int nj = std::max(0, j - 1); nj <= std::min(pop.cols - 1, j + 1); ++nj) {
+                size_t idx = static_cast<size_t>(ni) * pop.cols + nj;
+                double updated = cellRate(ni, nj);
+                tree.add(idx, updated - rate[idx]);
+                total += updated - rate[idx];
+                rate[idx] = updated;
+            }
+        }
+    }
+
+    // Recomputes every rate; also clears accumulated floating-point drift
+    void rebuild() {
+        total = 0.0;
+        for (int i = 0; i < pop.rows; ++i) {
+            for (int j = 0; j < pop.cols; ++j) {
+                rate[static_cast<size_t>(i) * pop.cols + j] = cellRate(i, j);
+                total += rate[static_cast<size_t>(i) * pop.cols + j];
+            }
+        }
+        tree.build(rate);
+    }
+
+    // Runs events until time 'horizon'; pop must already hold the initial state
+    void run(double horizon, const CounterRng& rng) {
+        rebuild();
+        const uint64_t rebuildEvery = 4 * rate.size() + 1024;
+        double t = 0.0;
+        events = 0;
+        while (total > 1e-12) {
+            Philox4x32 r = rng.block(static_cast<uint32_t>(events), events >> 32, StreamUpdate);
+            t += -std::log(1.0 - toUniform(r.v[0], r.v[1])) / total;
+            if (t > horizon) break;
+            ++events;
+
+            int idx = tree.find(toUniform(r.v[2], r.v[3]) * total);
+            if (rate[idx] <= 0.0) continue;  // landed on a zero-rate cell through rounding
+            int i = idx / pop.cols, j = idx % pop.cols;
+
+            // Pick the event kind within the cell with a second block
+            Philox4x32 kind = rng.block(static_cast<uint32_t>(events), events >> 32, StreamMove);
+            double pick = toUniform(kind.v[0], kind.v[1]) * rate[idx];
+            if (pick < moveRate) {
+                int d = kind.v[2] & 3;
+                int ni = i + directions[d][0];
+                int nj = j + directions[d][1];
+                if (ni < 0 || ni >= pop.rows || nj < 0 || nj >= pop.cols || pop.isOccupied(ni, nj)) continue;
+                pop.set(ni, nj, pop.state(i, j));
+                pop.clear(i, j);
+                refreshAround(i, j);
+                refreshAround(ni, nj);
+            } else {
+                pop.set(i, j, pop.state(i, j) == State::Susceptible ? State::Infected : State::Recovered);
+                refreshAround(i, j);
+            }
+
+            if (events % rebuildEvery == 0) rebuild();
+        }
+    }
+};
+
+// The discrete reference: the same loop as simulate() in SIR_parallel.cpp
+int simulateDiscrete(float beta, float gamma, int rows, int cols, int steps, float density, float moveProb,
+                     uint64_t key) {
+    CounterRng rng(key);
+    Grid pop(rows, cols), next(rows, cols);
+    std::vector<uint8_t> proposals;
+    initializePopulation(pop, density, rng);
+    seedPatientZero(pop, rng);
+    for (int s = 0; s < steps; ++s) {
+        stepBitsliced(beta, gamma, pop, next, rng, s);
+        movePopulation(pop, next, proposals, rng, s, moveProb);
+    }
+    return pop.countInfected();
+}
+
+// Usage: ./SIR_gillespie_cpp [runs] [rows cols] [steps] [beta gamma moveProb] [seed]
+int main(int argc, char* argv[]) {
+    const int runs = argc > 1 ? std::stoi(argv[1]) : 100;
+    const int rows = argc > 3 ? std::stoi(argv[2]) : 50;
+    const int cols = argc > 3 ? std::stoi(argv[3]) : 50;
+    const int steps = argc > 4 ? std::stoi(argv[4]) : 50;
+    const float beta = argc > 7 ? std::stof(argv[5]) : 0.2f;
+    const float gamma = argc > 7 ? std::stof(argv[6]) : 0.05f;
+    const float moveProb = argc > 7 ? std::stof(argv[7]) : 0.5f;
+    const uint64_t seed = argc > 8 ? std::stoull(argv[8]) : 42;
+    const float density = 0.7f;
+
+    std::vector<int> discrete(runs);
+    std::vector<int> continuous(runs);
+    std::vector<uint64_t> eventCounts(runs);
+
+    double t1 = omp_get_wtime();
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < runs; ++r) {
+        discrete[r] = simulateDiscrete(beta, gamma, rows, cols, steps, density, moveProb, (seed << 32) | r);
+    }
+    double t2 = omp_get_wtime();
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int r = 0; r < runs; ++r) {
+        uint64_t key = (seed << 32) | r;
+        CounterRng rng(key);
+        GillespieSim sim(rows, cols, beta, gamma, moveProb);
+        initializePopulation(sim.pop, density, rng);
+        seedPatientZero(sim.pop, rng);
+        sim.run(steps, rng);
+        continuous[r] = sim.pop.countInfected();
+        eventCounts[r] = sim.events;
+    }
+    double t3 = omp_get_wtime();
+
+    auto summarize = [runs](const std::vector<int>& values, double& mean, double& se) {
+        mean = 0.0;
+        for (int v : values) mean += v;
+        mean /= runs;
+        double var = 0.0;
+        for (int v : values) var += (v - mean) * (v - mean);
+        se = runs > 1 ? std::sqrt(var / (runs - 1) / runs) : 0.0;
+    };
+
+    uint64_t totalEvents = 0;
+    for (uint64_t e : eventCounts) totalEvents += e;
+    double mean, se;
+
+    std::cout << runs << " runs on a " << rows << " x " << cols << " grid, time horizon " << steps
+              << ", beta " << beta << ", gamma " << gamma << ", move probability " << moveProb << "\n";
+    summarize(discrete, mean, se);
+    std::cout << "Discrete simulate()  : " << mean << " +- " << se << " infected, "
+              << (t2 - t1) << " seconds\n";
+    summarize(continuous, mean, se);
+    std::cout << "Event-driven engine  : " << mean << " +- " << se << " infected, "
+              << (t3 - t2) << " seconds\n";
+    std::cout << "Events: " << totalEvents << " (" << totalEvents / (t3 - t2) << " events/s)\n";
+
+    return 0;
+}
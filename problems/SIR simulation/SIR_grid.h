@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Bit-packed structure-of-arrays grid shared by the C++ SIR simulations.
+//
+// Every cell takes 3 bits spread over three bitplanes (64 cells per word):
+//   occupied  - a person stands in the cell
+//   infected  - the person is infected
+//   recovered - the person is recovered
+// Susceptible is occupied & ~infected & ~recovered. Rows are padded to a whole
+// number of words so a row can be processed word-at-a-time; padding bits stay 0.
+
+enum class State { Susceptible, Infected, Recovered };
+
+struct Grid {
+    int rows = 0;
+    int cols = 0;
+    int words = 0;  // words per row
+    std::vector<uint64_t> occupied, infected, recovered;
+
+    Grid() = default;
+    Grid(int r, int c)
+        : rows(r), cols(c), words((c + 63) / 64),
+          occupied(static_cast<size_t>(r) * words, 0),
+          infected(static_cast<size_t>(r) * words, 0),
+          recovered(static_cast<size_t>(r) * words, 0) {}
+
+    size_t word(int i, int j) const { return static_cast<size_t>(i) * words + (j >> 6); }
+    static uint64_t bit(int j) { return uint64_t(1) << (j & 63); }
+
+    bool isOccupied(int i, int j) const { return occupied[word(i, j)] & bit(j); }
+    bool isInfected(int i, int j) const { return infected[word(i, j)] & bit(j); }
+
+    State state(int i, int j) const {
+        size_t w = word(i, j);
+        if (infected[w] & bit(j)) return State::Infected;
+        if (recovered[w] & bit(j)) return State::Recovered;
+        return State::Susceptible;
+    }
+
+    // Places a person in state s at (i, j)
+    void set(int i, int j, State s) {
+        size_t w = word(i, j);
+        uint64_t b = bit(j);
+        occupied[w] |= b;
+        infected[w] = s == State::Infected ? infected[w] | b : infected[w] & ~b;
+        recovered[w] = s == State::Recovered ? recovered[w] | b : recovered[w] & ~b;
+    }
+
+    void clear(int i, int j) {
+        size_t w = word(i, j);
+        uint64_t b = ~bit(j);
+        occupied[w] &= b;
+        infected[w] &= b;
+        recovered[w] &= b;
+    }
+
+    // Copies contents without reallocating (both grids have the same shape)
+    void copyFrom(const Grid& other) {
+        std::copy(other.occupied.begin(), other.occupied.end(), occupied.begin());
+        std::copy(other.infected.begin(), other.infected.end(), infected.begin());
+        std::copy(other.recovered.begin(), other.recovered.end(), recovered.begin());
+    }
+
+    void copyRow(const Grid& other, int i) {
+        size_t begin = static_cast<size_t>(i) * words, end = begin + words;
+        std::copy(other.occupied.begin() + begin, other.occupied.begin() + end, occupied.begin() + begin);
+        std::copy(other.infected.begin() + begin, other.infected.begin() + end, infected.begin() + begin);
+        std::copy(other.recovered.begin() + begin, other.recovered.begin() + end, recovered.begin() + begin);
+    }
+
+    void reset() {
+        std::fill(occupied.begin(), occupied.end(), 0);
+        std::fill(infected.begin(), infected.end(), 0);
+        std::fill(recovered.begin(), recovered.end(), 0);
+    }
+
+    void swap(Grid& other) {
+        std::swap(rows, other.rows);
+        std::swap(cols, other.cols);
+        std::swap(words, other.words);
+        occupied.swap(other.occupied);
+        infected.swap(other.infected);
+        recovered.swap(other.recovered);
+    }
+
+    int countInfected() const {
+        int total = 0;
+        for (uint64_t w : infected) total += __builtin_popcountll(w);
+        return total;
+    }
+
+    int countRecovered() const {
+        int total = 0;
+        for (uint64_t w : recovered) total += __builtin_popcountll(w);
+        return total;
+    }
+
+    size_t bytes() const {
+        return (occupied.size() + infected.size() + recovered.size()) * sizeof(uint64_t);
+    }
+};
+
+// Infection probability 1 - (1 - beta)^k for k = 0..8 infected neighbours,
+// computed once instead of calling pow() for every susceptible cell.
+inline void infectionTable(double beta, double table[9]) {
+    double escape = 1.0;
+    for (int k = 0; k <= 8; ++k) {
+        table[k] = 1.0 - escape;
+        escape *= 1.0 - beta;
+    }
+}
+
+// Bit-sliced Moore-neighbourhood count for the 64 cells of word w in row i.
+// The count of the cell at bit b is sum over k of ((c[k] >> b) & 1) << k.
+// The eight neighbour masks are built by shifting the infected plane of the
+// three rows by one column and summed with ripple-carry adders on 4 bitplanes.
+inline void countInfectedNeighbors(const Grid& g, int i, int w, uint64_t c[4]) {
+    c[0] = c[1] = c[2] = c[3] = 0;
+    auto add = [c](uint64_t m) {
+        for (int k = 0; m && k < 4; ++k) {
+            uint64_t carry = c[k] & m;
+            c[k] ^= m;
+            m = carry;
+        }
+    };
+    for (int r = i - 1; r <= i + 1; ++r) {
+        if (r < 0 || r >= g.rows) continue;
+        const uint64_t* row = &g.infected[static_cast<size_t>(r) * g.words];
+        uint64_t mid = row[w];
+        uint64_t prev = w > 0 ? row[w - 1] : 0;
+        uint64_t next = w + 1 < g.words ? row[w + 1] : 0;
+        add((mid << 1) | (prev >> 63));  // neighbour at column j - 1
+        add((mid >> 1) | (next << 63));  // neighbour at column j + 1
+        if (r != i) add(mid);
+    }
+}
+
+inline int neighborCount(const uint64_t c[4], int b) {
+    return static_cast<int>(((c[0] >> b) & 1) | (((c[1] >> b) & 1) << 1) |
+                            (((c[2] >> b) & 1) << 2) | (((c[3] >> b) & 1) << 3));
+}
+
+// Same count for word 'up[0]'/'mid[0]'/'down[0]' of three consecutive rows of an
+// infected plane, where the caller guarantees that the words at [-1] and [+1]
+// are valid (padding or halo words). Used when rows come from several tiles.
+inline void countInfectedNeighbors(const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                                   uint64_t c[4]) {
+    c[0] = c[1] = c[2] = c[3] = 0;
+    auto add = [c](uint64_t m) {
+        for (int k = 0; m && k < 4; ++k) {
+            uint64_t carry = c[k] & m;
+            c[k] ^= m;
+            m = carry;
+        }
+    };
+    for (const uint64_t* row : {up, mid, down}) {
+        add((row[0] << 1) | (row[-1] >> 63));
+        add((row[0] >> 1) | (row[1] << 63));
+        if (row != mid) add(row[0]);
+    }
+}
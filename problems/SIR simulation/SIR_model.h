@@ -0,0 +1,225 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include "SIR_grid.h"
+#include "SIR_rng.h"
+
+// The SIR model with movement used by SIR_parallel.cpp and the programs built on
+// it: initialization, the infection/recovery step (scalar and bit-sliced) and the
+// parallel propose/commit movement. Every function works on preallocated Grids
+// and draws from the counter-based generator keyed by (run, step, cell).
+
+// Fills 'pop' (already sized) with susceptible people at the given density
+inline void initializePopulation(Grid& pop, float density, const CounterRng& rng) {
+    int rows = pop.rows, cols = pop.cols;
+    pop.reset();
+    
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            if (rng.uniform(0, static_cast<uint64_t>(i) * cols + j, StreamInit) < density) {
+                pop.set(i, j, State::Susceptible);
+            }
+        }
+    }
+}
+
+// Infects one randomly chosen occupied cell
+inline void seedPatientZero(Grid& pop, const CounterRng& rng) {
+    for (uint32_t attempt = 0; ; ++attempt) {
+        Philox4x32 r = rng.block(attempt, 0, StreamSeed);
+        int i = r.v[0] % pop.rows;
+        int j = r.v[1] % pop.cols;
+        if (pop.isOccupied(i, j)) {
+            pop.set(i, j, State::Infected);
+            return;
+        }
+    }
+}
+
+// Directions: right, down, left, up
+constexpr int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+
+// Highest-priority proposal to move into cell (i, j), or 0 if nobody wants to.
+// A proposal byte is 0x80 | priority << 2 | direction, so comparing bytes
+// compares the random 5-bit priorities first and breaks ties by direction.
+inline uint8_t winningProposal(const std::vector<uint8_t>& proposals, int rows, int cols, int i, int j) {
+    uint8_t best = 0;
+    for (int d = 0; d < 4; ++d) {
+        int si = i - directions[d][0];
+        int sj = j - directions[d][1];
+        if (si < 0 || si >= rows || sj < 0 || sj >= cols) continue;
+        uint8_t p = proposals[static_cast<size_t>(si) * cols + sj];
+        if (p && (p & 3) == d && p > best) best = p;
+    }
+    return best;
+}
+
+// Moves people from 'pop' into 'next' (same shape), then swaps them.
+// Runs in two parallel phases, so the outcome depends neither on scan order nor
+// on the number of threads:
+//   propose - each person decides from its own Philox block whether to move and
+//             where; only moves into cells that are empty in 'pop' are kept
+//   commit  - each cell gathers its new content: an empty cell takes the winning
+//             proposal aimed at it, and a person leaves only if it won. Every row
+//             writes just its own words of 'next'.
+inline void movePopulation(Grid& pop, Grid& next, std::vector<uint8_t>& proposals, const CounterRng& rng,
+                    uint32_t stepNum, float moveProb = 0.5) {
+    int rows = pop.rows;
+    if (rows == 0) return;
+    int cols = pop.cols;
+    proposals.resize(static_cast<size_t>(rows) * cols);
+    
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static)
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                size_t cell = static_cast<size_t>(i) * cols + j;
+                proposals[cell] = 0;
+                if (!pop.isOccupied(i, j)) continue;
+                // One Philox block gives the move decision, direction and priority
+                Philox4x32 r = rng.block(stepNum, cell, StreamMove);
+                if (toUniform(r.v[0], r.v[1]) >= moveProb) continue;
+                int d = r.v[2] & 3;
+                int ni = i + directions[d][0];
+                int nj = j + directions[d][1];
+                if (ni >= 0 && ni < rows && nj >= 0 && nj < cols && !pop.isOccupied(ni, nj)) {
+                    proposals[cell] = static_cast<uint8_t>(0x80 | ((r.v[3] & 31) << 2) | d);
+                }
+            }
+        }
+        
+        #pragma omp for schedule(static)
+        for (int i = 0; i < rows; ++i) {
+            for (int w = 0; w < pop.words; ++w) {
+                uint64_t occupied = 0, infected = 0, recovered = 0;
+                int jEnd = std::min(cols, 64 * (w + 1));
+                for (int j = 64 * w; j < jEnd; ++j) {
+                    int si = i, sj = j;  // where this cell's next occupant comes from
+                    if (pop.isOccupied(i, j)) {
+                        uint8_t p = proposals[static_cast<size_t>(i) * cols + j];
+                        if (p) {
+                            int d = p & 3;
+                            uint8_t won = winningProposal(proposals, rows, cols,
+                                                          i + directions[d][0], j + directions[d][1]);
+                            if (won == p) continue;  // moved out
+                        }
+                    } else {
+                        uint8_t won = winningProposal(proposals, rows, cols, i, j);
+                        if (!won) continue;
+                        si = i - directions[won & 3][0];
+                        sj = j - directions[won & 3][1];
+                    }
+                    uint64_t b = Grid::bit(j);
+                    occupied |= b;
+                    if (pop.isInfected(si, sj)) infected |= b;
+                    else if (pop.state(si, sj) == State::Recovered) recovered |= b;
+                }
+                size_t idx = static_cast<size_t>(i) * pop.words + w;
+                next.occupied[idx] = occupied;
+                next.infected[idx] = infected;
+                next.recovered[idx] = recovered;
+            }
+        }
+    }
+    
+    pop.swap(next);
+}
+
+// Computes the next generation of 'pop' into 'next', then swaps them
+inline void step(float beta, float gamma, Grid& pop, Grid& next, const CounterRng& rng, uint32_t stepNum) {
+    int rows = pop.rows;
+    if (rows == 0) return;
+    int cols = pop.cols;
+    
+    // Rows only write their own words of 'next', and every draw is keyed by its
+    // cell, so rows can be split across threads
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < rows; ++i) {
+        next.copyRow(pop, i);
+        for (int j = 0; j < cols; ++j) {
+            if (!pop.isOccupied(i, j)) continue;
+            
+            switch (pop.state(i, j)) {
+                case State::Susceptible: {
+                    int infectedNeighbors = 0;
+                    for (int di = -1; di <= 1; ++di) {
+                        for (int dj = -1; dj <= 1; ++dj) {
+                            if (di == 0 && dj == 0) continue;
+                            int ni = i + di;
+                            int nj = j + dj;
+                            if (ni >= 0 && ni < rows && nj >= 0 && nj < cols && 
+                                pop.isInfected(ni, nj)) {
+                                infectedNeighbors++;
+                            }
+                        }
+                    }
+                    float prob = 1.0 - std::pow(1.0 - beta, infectedNeighbors);
+                    if (rng.uniform(stepNum, static_cast<uint64_t>(i) * cols + j) < prob) {
+                        next.set(i, j, State::Infected);
+                    }
+                    break;
+                }
+                case State::Infected:
+                    if (rng.uniform(stepNum, static_cast<uint64_t>(i) * cols + j) < gamma) {
+                        next.set(i, j, State::Recovered);
+                    }
+                    break;
+                case State::Recovered:
+                    // No change
+                    break;
+            }
+        }
+    }
+    
+    // printPopulation(next);
+    pop.swap(next);
+}
+
+// Same update as step(), but 64 cells at a time: infected neighbours are counted
+// with the bit-sliced kernel from SIR_grid.h, the infection probability is looked
+// up in a 9-entry table, and random numbers are drawn only for susceptible cells
+// with at least one infected neighbour and for infected cells.
+inline void stepBitsliced(double beta, double gamma, Grid& pop, Grid& next, const CounterRng& rng, uint32_t stepNum) {
+    double infectProb[9];
+    infectionTable(beta, infectProb);
+
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < pop.rows; ++i) {
+        next.copyRow(pop, i);
+        for (int w = 0; w < pop.words; ++w) {
+            size_t idx = static_cast<size_t>(i) * pop.words + w;
+            uint64_t base = static_cast<uint64_t>(i) * pop.cols + 64 * w;
+            uint64_t infected = pop.infected[idx];
+            uint64_t susceptible = pop.occupied[idx] & ~infected & ~pop.recovered[idx];
+
+            if (susceptible) {
+                uint64_t c[4];
+                countInfectedNeighbors(pop, i, w, c);
+                uint64_t exposed = susceptible & (c[0] | c[1] | c[2] | c[3]);
+                while (exposed) {
+                    int b = __builtin_ctzll(exposed);
+                    exposed &= exposed - 1;
+                    if (rng.uniform(stepNum, base + b) < infectProb[neighborCount(c, b)]) {
+                        next.infected[idx] |= uint64_t(1) << b;
+                    }
+                }
+            }
+
+            while (infected) {
+                int b = __builtin_ctzll(infected);
+                infected &= infected - 1;
+                if (rng.uniform(stepNum, base + b) < gamma) {
+                    next.infected[idx] &= ~(uint64_t(1) << b);
+                    next.recovered[idx] |= uint64_t(1) << b;
+                }
+            }
+        }
+    }
+
+    pop.swap(next);
+}
@@ -1,10 +1,12 @@
 #include <iostream>
 #include <vector>
-#include <random>
 #include <chrono>
+#include <cmath>
+#include <string>
 #include <omp.h>  // OpenMP
-
-enum class State { Susceptible, Infected, Recovered };
+#include "SIR_grid.h"
+#include "SIR_model.h"
+#include "SIR_rng.h"
 
 struct Person {
     State state = State::Susceptible;
@@ -12,10 +14,11 @@ struct Person {
 
 using Population = std::vector<std::vector<Person>>;
 
-void step(double beta, double gamma, Population& pop, std::mt19937& rng) {
+// Every cell draws its random number from the counter-based generator keyed by
+// (run, step, cell), so the parallel loop shares no RNG state.
+void step(double beta, double gamma, Population& pop, const CounterRng& rng, uint32_t step_num) {
     int rows = pop.size();
     int cols = pop[0].size();
-    std::uniform_real_distribution<> dist(0.0, 1.0);
 
     Population next_pop = pop; // Copy for updating in parallel safely
 
@@ -38,11 +41,11 @@ void step(double beta, double gamma, Population& pop, std::mt19937& rng) {
                     }
                 }
                 double prob = 1.0 - pow(1.0 - beta, infected_neighbors);
-                if (dist(rng) < prob) {
+                if (rng.uniform(step_num, static_cast<uint64_t>(i) * cols + j) < prob) {
                     next_pop[i][j].state = State::Infected;
                 }
             } else if (person.state == State::Infected) {
-                if (dist(rng) < gamma) {
+                if (rng.uniform(step_num, static_cast<uint64_t>(i) * cols + j) < gamma) {
                     next_pop[i][j].state = State::Recovered;
                 }
             }
@@ -52,13 +55,13 @@ void step(double beta, double gamma, Population& pop, std::mt19937& rng) {
     pop = next_pop; // Update
 }
 
-int simulate(double beta, double gamma, int rows, int cols, int steps, unsigned int seed) {
+int simulate(double beta, double gamma, int rows, int cols, int steps, uint64_t key) {
     Population pop(rows, std::vector<Person>(cols));
     pop[rows/2][cols/2].state = State::Infected;
-    std::mt19937 rng(seed);
+    CounterRng rng(key);
 
     for (int step_num = 0; step_num < steps; ++step_num) {
-        step(beta, gamma, pop, rng);
+        step(beta, gamma, pop, rng, step_num);
     }
 
     int infected = 0;
@@ -70,7 +73,27 @@ int simulate(double beta, double gamma, int rows, int cols, int steps, unsigned
     return infected;
 }
 
-int main() {
+// Alternate step on the bit-packed grid: stepBitsliced() from SIR_model.h. Runs
+// are the parallel dimension here, so its row loop (a nested parallel region)
+// runs on the calling thread.
+int simulateBitsliced(double beta, double gamma, int rows, int cols, int steps, uint64_t key) {
+    Grid pop(rows, cols), next(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) pop.set(i, j, State::Susceptible);
+    }
+    pop.set(rows/2, cols/2, State::Infected);
+    CounterRng rng(key);
+
+    for (int step_num = 0; step_num < steps; ++step_num) {
+        stepBitsliced(beta, gamma, pop, next, rng, step_num);
+    }
+    return pop.countInfected();
+}
+
+// Usage: ./SIR_parallel_simple_cpp [scalar|bitsliced] [seed]
+int main(int argc, char* argv[]) {
+    const bool bitsliced = argc > 1 && std::string(argv[1]) == "bitsliced";
+    const uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 42;
     const int runs = 1000;
     const double beta = 0.2;
     const double gamma = 0.1;
@@ -84,8 +107,9 @@ int main() {
 
 #pragma omp parallel for
     for (int i = 0; i < runs; ++i) {
-        unsigned int seed = i + time(0);  // Different seed per thread
-        infections[i] = simulate(beta, gamma, rows, cols, steps, seed);
+        uint64_t key = (seed << 32) | static_cast<uint32_t>(i);  // Run i's stream, same for any thread count
+        infections[i] = bitsliced ? simulateBitsliced(beta, gamma, rows, cols, steps, key)
+                                  : simulate(beta, gamma, rows, cols, steps, key);
     }
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -101,6 +125,8 @@ int main() {
 
     std::cout << "Average infections at end of simulation: " << avg << "\n";
     std::cout << "Time taken: " << diff.count() << " seconds\n";
+    std::cout << "Throughput: " << static_cast<double>(runs) * rows * cols * steps / diff.count()
+              << " cell updates/s\n";
 
     return 0;
 }
\ No newline at end of file
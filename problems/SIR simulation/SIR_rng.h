@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. SC'11) for the C++
+// SIR simulations.
+//
+// A draw is a pure function of (key, counter): the key identifies the run and the
+// counter identifies (step, cell, stream). There is no generator state to share
+// or lock, so any thread can produce any cell's numbers, and a simulation gives
+// bit-identical results for every thread count and iteration order.
+
+struct Philox4x32 {
+    uint32_t v[4];
+};
+
+inline Philox4x32 philox4x32(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                             uint32_t k0, uint32_t k1) {
+    const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+    const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+    for (int round = 0; round < 10; ++round) {
+        uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+        uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<uint32_t>(p1);
+        c3 = static_cast<uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += W0;
+        k1 += W1;
+    }
+    return {{c0, c1, c2, c3}};
+}
+
+// 53-bit uniform double in [0, 1) from two 32-bit words
+inline double toUniform(uint32_t hi, uint32_t lo) {
+    return static_cast<double>(((static_cast<uint64_t>(hi) << 32) | lo) >> 11) * 0x1.0p-53;
+}
+
+// Streams separate independent uses of the same (step, cell) counter
+enum RngStream : uint32_t { StreamInit = 0, StreamUpdate = 1, StreamMove = 2, StreamSeed = 3 };
+
+struct CounterRng {
+    uint32_t k0, k1;
+
+    explicit CounterRng(uint64_t key)
+        : k0(static_cast<uint32_t>(key)), k1(static_cast<uint32_t>(key >> 32)) {}
+
+    Philox4x32 block(uint32_t step, uint64_t cell, RngStream stream) const {
+        return philox4x32(step, static_cast<uint32_t>(cell), static_cast<uint32_t>(cell >> 32),
+                          stream, k0, k1);
+    }
+
+    // One uniform in [0, 1) for (step, cell, stream)
+    double uniform(uint32_t step, uint64_t cell, RngStream stream = StreamUpdate) const {
+        Philox4x32 r = block(step, cell, stream);
+        return toUniform(r.v[0], r.v[1]);
+    }
+};
@@ -0,0 +1,271 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <omp.h>
+#include "SIR_grid.h"
+#include "SIR_rng.h"
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
+
+// Large-grid SIR (simple model, no movement) on a tiled domain decomposition.
+//
+// The grid is cut into tiles of tileRows x (64 * tileWords) cells, each stored as
+// two bit-packed Grids (versions v and v + 1 alternate between them). Every
+// thread owns a contiguous band of tiles. Instead of a global barrier per step, a
+// tile advances from version v to v + 1 as soon as its eight neighbours have
+// published version v (an atomic counter per tile). That one condition also
+// guarantees that the neighbours have finished reading the buffer being
+// overwritten, so threads can drift several steps apart where the epidemic
+// allows it. The one-cell halo is gathered from the neighbour tiles into a
+// per-thread scratch copy of the infected plane before a tile is updated.
+//
+// Built with -DUSE_MPI, each rank owns a band of rows, and the infected rows just
+// above/below it are exchanged with the neighbouring ranks before every step.
+//
+// Random numbers are keyed by global (step, cell), so the result is the same for
+// any tile size, thread count or rank count, and matches the 'bitsliced' step of
+// SIR_parallel_simple.cpp for the same seed.
+
+struct TiledGrid {
+    int rows = 0;         // rows owned by this rank
+    int cols = 0;
+    int rowOffset = 0;    // global index of local row 0
+    int tileRows = 0;
+    int tileWords = 0;    // tile width in 64-cell words
+    int tilesY = 0, tilesX = 0;
+    int colWords = 0;
+    std::vector<Grid> buffers[2];
+    std::unique_ptr<std::atomic<int>[]> done;  // latest version published per tile
+    std::vector<uint64_t> ghostNorth, ghostSouth;  // infected rows of the neighbouring ranks
+
+    TiledGrid(int rows_, int cols_, int rowOffset_, int tileRows_, int tileWords_)
+        : rows(rows_), cols(cols_), rowOffset(rowOffset_), tileRows(tileRows_), tileWords(tileWords_) {
+        tilesY = (rows + tileRows - 1) / tileRows;
+        colWords = (cols + 63) / 64;
+        tilesX = (colWords + tileWords - 1) / tileWords;
+        for (auto& buffer : buffers) {
+            buffer.reserve(static_cast<size_t>(tilesY) * tilesX);
+            for (int ty = 0; ty < tilesY; ++ty) {
+                for (int tx = 0; tx < tilesX; ++tx) {
+                    int h = std::min(tileRows, rows - ty * tileRows);
+                    int w = std::min(64 * tileWords, cols - 64 * tileWords * tx);
+                    buffer.emplace_back(h, w);
+                }
+            }
+        }
+        done.reset(new std::atomic<int>[static_cast<size_t>(tilesY) * tilesX]);
+        for (int t = 0; t < tilesY * tilesX; ++t) done[t].store(0);
+        ghostNorth.assign(colWords, 0);
+        ghostSouth.assign(colWords, 0);
+    }
+
+    int numTiles() const { return tilesY * tilesX; }
+
+    Grid& tile(int t, int version) { return buffers[version & 1][t]; }
+
+    // Infected word 'gw' of local row r (r may be -1 or rows) at 'version'
+    uint64_t infectedWord(int r, int gw, int version) const {
+        if (gw < 0 || gw >= colWords) return 0;
+        if (r < 0) return ghostNorth[gw];
+        if (r >= rows) return ghostSouth[gw];
+        const Grid& g = buffers[version & 1][(r / tileRows) * tilesX + gw / tileWords];
+        return g.infected[static_cast<size_t>(r % tileRows) * g.words + gw % tileWords];
+    }
+
+    void set(int globalRow, int col, State s) {
+        int r = globalRow - rowOffset;
+        if (r < 0 || r >= rows) return;
+        int t = (r / tileRows) * tilesX + col / (64 * tileWords);
+        tile(t, 0).set(r % tileRows, col % (64 * tileWords), s);
+    }
+
+    long long countInfected(int version) const {
+        long long total = 0;
+        for (const auto& g : buffers[version & 1]) total += g.countInfected();
+        return total;
+    }
+};
+
+// Computes version v + 1 of tile t from version v of it and its neighbours
+void advanceTile(TiledGrid& grid, int t, int v, const double infectProb[9], double gamma,
+                 const CounterRng& rng, std::vector<uint64_t>& scratch) {
+    int ty = t / grid.tilesX, tx = t % grid.tilesX;
+    const Grid& cur = grid.tile(t, v);
+    Grid& next = grid.tile(t, v + 1);
+    int h = cur.rows, k = cur.words, stride = k + 2;
+    int r0 = ty * grid.tileRows, w0 = tx * grid.tileWords;
+
+    // Infected plane with a one-cell halo: rows -1..h, words -1..k
+    scratch.resize(static_cast<size_t>(h + 2) * stride);
+    for (int r = -1; r <= h; ++r) {
+        uint64_t* row = &scratch[static_cast<size_t>(r + 1) * stride];
+        if (r < 0 || r == h) {
+            for (int wi = -1; wi <= k; ++wi) row[wi + 1] = grid.infectedWord(r0 + r, w0 + wi, v);
+        } else {
+            row[0] = grid.infectedWord(r0 + r, w0 - 1, v);
+            std::copy(cur.infected.begin() + static_cast<size_t>(r) * k,
+                      cur.infected.begin() + static_cast<size_t>(r + 1) * k, row + 1);
+            row[k + 1] = grid.infectedWord(r0 + r, w0 + k, v);
+        }
+    }
+
+    for (int r = 0; r < h; ++r) {
+        uint64_t rowBase = static_cast<uint64_t>(grid.rowOffset + r0 + r) * grid.cols;
+        for (int wi = 0; wi < k; ++wi) {
+            size_t idx = static_cast<size_t>(r) * k + wi;
+            uint64_t occupied = cur.occupied[idx];
+            uint64_t infected = cur.infected[idx];
+            uint64_t recovered = cur.recovered[idx];
+            uint64_t susceptible = occupied & ~infected & ~recovered;
+            uint64_t base = rowBase + 64 * static_cast<uint64_t>(w0 + wi);
+            uint64_t newInfected = infected, newRecovered = recovered;
+
+            if (susceptible) {
+                uint64_t c[4];
+                const uint64_t* mid = &scratch[static_cast<size_t>(r + 1) * stride + wi + 1];
+                countInfectedNeighbors(mid - stride, mid, mid + stride, c);
+                uint64_t exposed = susceptible & (c[0] | c[1] | c[2] | c[3]);
+                while (exposed) {
+                    int b = __builtin_ctzll(exposed);
+                    exposed &= exposed - 1;
+                    if (rng.uniform(v, base + b) < infectProb[neighborCount(c, b)]) {
+                        newInfected |= uint64_t(1) << b;
+                    }
+                }
+            }
+
+            while (infected) {
+                int b = __builtin_ctzll(infected);
+                infected &= infected - 1;
+                if (rng.uniform(v, base + b) < gamma) {
+                    newInfected &= ~(uint64_t(1) << b);
+                    newRecovered |= uint64_t(1) << b;
+                }
+            }
+
+            next.occupied[idx] = occupied;
+            next.infected[idx] = newInfected;
+            next.recovered[idx] = newRecovered;
+        }
+    }
+}
+
+// Advances every tile from version vBegin to vEnd. Each thread walks its own band
+// of tiles and only waits for the neighbours of the tile it is about to update.
+void advanceSteps(TiledGrid& grid, int vBegin, int vEnd, double beta, double gamma, const CounterRng& rng) {
+    double infectProb[9];
+    infectionTable(beta, infectProb);
+
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int nthreads = omp_get_num_threads();
+        int n = grid.numTiles();
+        int lo = static_cast<long long>(n) * tid / nthreads;
+        int hi = static_cast<long long>(n) * (tid + 1) / nthreads;
+        std::vector<uint64_t> scratch;
+
+        for (int v = vBegin; v < vEnd; ++v) {
+            for (int t = lo; t < hi; ++t) {
+                int ty = t / grid.tilesX, tx = t % grid.tilesX;
+                for (int ny = std::max(0, ty - 1); ny <= std::min(grid.tilesY - 1, ty + 1); ++ny) {
+                    for (int nx = std::max(0, tx - 1); nx <= std::min(grid.tilesX - 1, tx + 1); ++nx) {
+                        const auto& flag = grid.done[ny * grid.tilesX + nx];
+                        while (flag.load(std::memory_order_acquire) < v) std::this_thread::yield();
+                    }
+                }
+                advanceTile(grid, t, v, infectProb, gamma, rng, scratch);
+                grid.done[t].store(v + 1, std::memory_order_release);
+            }
+        }
+    }
+}
+
+#ifdef USE_MPI
+// Swaps the first/last owned rows of the infected plane with the ranks above/below
+void exchangeHalos(TiledGrid& grid, int version, int rank, int size) {
+    std::vector<uint64_t> top(grid.colWords), bottom(grid.colWords);
+    for (int gw = 0; gw < grid.colWords; ++gw) {
+        top[gw] = grid.infectedWord(0, gw, version);
+        bottom[gw] = grid.infectedWord(grid.rows - 1, gw, version);
+    }
+    int north = rank > 0 ? rank - 1 : MPI_PROC_NULL;
+    int south = rank + 1 < size ? rank + 1 : MPI_PROC_NULL;
+    MPI_Sendrecv(top.data(), grid.colWords, MPI_UINT64_T, north, 0,
+                 grid.ghostSouth.data(), grid.colWords, MPI_UINT64_T, south, 0,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(bottom.data(), grid.colWords, MPI_UINT64_T, south, 1,
+                 grid.ghostNorth.data(), grid.colWords, MPI_UINT64_T, north, 1,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+}
+#endif
+
+// Usage: ./SIR_tiled_cpp [rows cols steps [tileRows tileCols [seed]]]
+//        mpirun -n 4 ./SIR_tiled_mpi [same arguments]
+int main(int argc, char* argv[]) {
+    int rank = 0, size = 1;
+#ifdef USE_MPI
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+    const int rows = argc > 1 ? std::stoi(argv[1]) : 10000;
+    const int cols = argc > 2 ? std::stoi(argv[2]) : 10000;
+    const int steps = argc > 3 ? std::stoi(argv[3]) : 20;
+    const int tileRows = argc > 4 ? std::stoi(argv[4]) : 256;
+    const int tileWords = std::max(1, (argc > 5 ? std::stoi(argv[5]) : 256) / 64);
+    const uint64_t seed = argc > 6 ? std::stoull(argv[6]) : 42;
+    const double beta = 0.2;
+    const double gamma = 0.1;
+
+    int rowBegin = static_cast<long long>(rows) * rank / size;
+    int rowEnd = static_cast<long long>(rows) * (rank + 1) / size;
+    TiledGrid grid(rowEnd - rowBegin, cols, rowBegin, tileRows, tileWords);
+    CounterRng rng(seed << 32);
+
+    for (int t = 0; t < grid.numTiles(); ++t) {
+        Grid& g = grid.tile(t, 0);
+        for (int i = 0; i < g.rows; ++i) {
+            for (int j = 0; j < g.cols; ++j) g.set(i, j, State::Susceptible);
+        }
+    }
+    grid.set(rows / 2, cols / 2, State::Infected);
+
+    double t1 = omp_get_wtime();
+#ifdef USE_MPI
+    for (int v = 0; v < steps; ++v) {
+        exchangeHalos(grid, v, rank, size);
+        advanceSteps(grid, v, v + 1, beta, gamma, rng);
+    }
+#else
+    advanceSteps(grid, 0, steps, beta, gamma, rng);
+#endif
+    double t2 = omp_get_wtime();
+
+    long long infected = grid.countInfected(steps);
+#ifdef USE_MPI
+    long long localInfected = infected;
+    MPI_Reduce(&localInfected, &infected, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+#endif
+
+    if (rank == 0) {
+        std::cout << "Grid " << rows << " x " << cols << ", tiles " << tileRows << " x " << 64 * tileWords
+                  << ", " << size << " rank(s) x " << omp_get_max_threads() << " thread(s)\n";
+        std::cout << "Infected at end of simulation: " << infected << "\n";
+        std::cout << "Time taken: " << (t2 - t1) << " seconds\n";
+        std::cout << "Throughput: " << static_cast<double>(rows) * cols * steps / (t2 - t1)
+                  << " cell updates/s\n";
+    }
+
+#ifdef USE_MPI
+    MPI_Finalize();
+#endif
+    return 0;
+}
@@ -0,0 +1,217 @@
+// C++ MPI word count, the counterpart of MPI_WC.ml.
+//
+// Instead of rank 0 reading and broadcasting the whole word array, every rank
+// reads only its own byte range of the file. A word belongs to the rank whose
+// range contains its first byte, so ranges are widened/narrowed to whitespace.
+// Local counts are then shuffled by hash partition: each word goes to rank
+// hash(word) % size, encoded compactly as
+//     varint(num_words) | { varint(len) word_bytes }* | { varint(count) }*
+// (a dictionary block followed by a counts block) and exchanged with one
+// MPI_Alltoallv. Each rank ends up owning the final counts of its partition.
+//
+// Usage: mpirun -n 4 ./cpp_MPI_WC [input_file] [-v]
+//   -v  print the final counts, each rank printing the partition it owns
+
+#include <mpi.h>
+#include <iostream>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cctype>
+
+using namespace std;
+
+inline uint64_t hash_word(const string& w) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : w) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+inline void put_varint(vector<char>& buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf.push_back(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    buf.push_back(static_cast<char>(v));
+}
+
+inline uint64_t get_varint(const char*& p) {
+    uint64_t v = 0;
+    int shift = 0;
+    while (true) {
+        unsigned char b = static_cast<unsigned char>(*p++);
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+        shift += 7;
+    }
+}
+
+// Reads the words whose first byte lies in [begin, end).
+string read_range(const string& filename, long long begin, long long end, long long file_size) {
+    ifstream in(filename, ios::binary);
+    long long start = begin;
+    if (begin > 0) {
+        // Skip a word that started in the previous rank's range
+        in.seekg(begin - 1);
+        char c;
+        in.get(c);
+        if (!isspace(static_cast<unsigned char>(c))) {
+            while (start < file_size && in.get(c) && !isspace(static_cast<unsigned char>(c))) ++start;
+        }
+    }
+    if (start >= end) return "";
+
+    // Finish a word that is still open at the end of our range
+    long long stop = end;
+    in.clear();
+    in.seekg(end - 1);
+    char c;
+    in.get(c);
+    if (!isspace(static_cast<unsigned char>(c))) {
+        while (stop < file_size && in.get(c) && !isspace(static_cast<unsigned char>(c))) ++stop;
+    }
+
+    string text(stop - start, '\0');
+    in.clear();
+    in.seekg(start);
+    in.read(&text[0], text.size());
+    text.resize(in.gcount());
+    return text;
+}
+
+void count_buffer(const string& text, unordered_map<string, uint64_t>& counts) {
+    string cleaned;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        char c = i < text.size() ? text[i] : ' ';
+        if (isspace(static_cast<unsigned char>(c))) {
+            if (!cleaned.empty()) {
+                counts[cleaned]++;
+                cleaned.clear();
+            }
+        } else if (isalpha(static_cast<unsigned char>(c))) {
+            cleaned += tolower(c);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    string filename = "input.txt";
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-v") verbose = true;
+        else filename = arg;
+    }
+
+    double start_time = MPI_Wtime();
+
+    // File read phase: each rank reads its own byte range
+    double file_read_start = MPI_Wtime();
+    long long file_size = 0;
+    if (rank == 0) {
+        ifstream in(filename, ios::binary | ios::ate);
+        file_size = in ? static_cast<long long>(in.tellg()) : -1;
+    }
+    MPI_Bcast(&file_size, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+    if (file_size < 0) {
+        if (rank == 0) cerr << "Could not open " << filename << "\n";
+        MPI_Finalize();
+        return 1;
+    }
+    long long begin = file_size * rank / size;
+    long long end = file_size * (rank + 1) / size;
+    string text = read_range(filename, begin, end, file_size);
+    double file_read_end = MPI_Wtime();
+    printf("Process %d File Read     : %.6f seconds\n", rank, file_read_end - file_read_start);
+
+    // Local counting
+    double computation_start = MPI_Wtime();
+    unordered_map<string, uint64_t> local_counts;
+    count_buffer(text, local_counts);
+    double computation_end = MPI_Wtime();
+    printf("Process %d Computation Time  : %.6f seconds\n", rank, computation_end - computation_start);
+
+    // Shuffle: encode per destination, exchange sizes, then payloads
+    double communication_start = MPI_Wtime();
+    vector<vector<const pair<const string, uint64_t>*>> partitions(size);
+    for (const auto& entry : local_counts) {
+        partitions[hash_word(entry.first) % size].push_back(&entry);
+    }
+
+    vector<char> send_buf;
+    vector<int> send_counts(size), send_displs(size);
+    for (int r = 0; r < size; ++r) {
+        send_displs[r] = send_buf.size();
+        put_varint(send_buf, partitions[r].size());
+        for (const auto* e : partitions[r]) {
+            put_varint(send_buf, e->first.size());
+            send_buf.insert(send_buf.end(), e->first.begin(), e->first.end());
+        }
+        for (const auto* e : partitions[r]) put_varint(send_buf, e->second);
+        send_counts[r] = send_buf.size() - send_displs[r];
+    }
+
+    vector<int> recv_counts(size), recv_displs(size);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    int recv_total = 0;
+    for (int r = 0; r < size; ++r) {
+        recv_displs[r] = recv_total;
+        recv_total += recv_counts[r];
+    }
+    vector<char> recv_buf(recv_total);
+    MPI_Alltoallv(send_buf.data(), send_counts.data(), send_displs.data(), MPI_CHAR,
+                  recv_buf.data(), recv_counts.data(), recv_displs.data(), MPI_CHAR, MPI_COMM_WORLD);
+
+    unordered_map<string, uint64_t> owned_counts;
+    vector<string> dictionary;
+    for (int r = 0; r < size; ++r) {
+        const char* p = recv_buf.data() + recv_displs[r];
+        uint64_t n = get_varint(p);
+        dictionary.clear();
+        for (uint64_t i = 0; i < n; ++i) {
+            uint64_t len = get_varint(p);
+            dictionary.emplace_back(p, len);
+            p += len;
+        }
+        for (uint64_t i = 0; i < n; ++i) owned_counts[dictionary[i]] += get_varint(p);
+    }
+
+    unsigned long long owned[2] = {0, owned_counts.size()}, totals[2];
+    for (const auto& [word, count] : owned_counts) owned[0] += count;
+    MPI_Reduce(owned, totals, 2, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    double communication_end = MPI_Wtime();
+    printf("Process %d Communication Time: %.6f seconds (%zu bytes sent)\n",
+           rank, communication_end - communication_start, send_buf.size());
+
+    if (verbose) {
+        // Ranks print their own partitions in turn
+        for (int r = 0; r < size; ++r) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            if (r != rank) continue;
+            for (const auto& [word, count] : owned_counts) {
+                printf("%s: %llu\n", word.c_str(), static_cast<unsigned long long>(count));
+            }
+            fflush(stdout);
+        }
+    }
+
+    if (rank == 0) {
+        printf("\nTotal words: %llu (%llu distinct)\n", totals[0], totals[1]);
+    }
+    double end_time = MPI_Wtime();
+    printf("Process %d Execution Time: %.6f seconds\n", rank, end_time - start_time);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,297 @@
+// Directory-scale word count with a work-stealing scheduler.
+//
+// Accepts any mix of files and directories (directories are walked recursively).
+// The input is turned into tasks before counting starts:
+//   - files larger than CHUNK_BYTES are split into chunks ending on whitespace
+//   - smaller files are batched together until a batch holds ~CHUNK_BYTES
+// Tasks are dealt largest-first to per-thread deques. Each thread pops from the
+// back of its own deque and, once empty, steals from the front of the others, so
+// a few huge files cannot leave the remaining threads idle.
+//
+// Word splitting matches parallel_WC.cpp: whitespace separated tokens, keeping
+// only alphabetic characters, lowercased.
+//
+// Usage: ./cpp_multi_WC [-p] [-t threads] path [path ...]
+//   -p  also write per-file counts to wc_per_file_counts.txt
+
+#include <iostream>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <omp.h>
+#include <cctype>
+#include <chrono>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+const size_t CHUNK_BYTES = 4 << 20;       // target bytes of input per task
+const size_t MAX_FILES_PER_BATCH = 256;   // bound on open/close overhead per task
+
+struct Piece {
+    int file;        // index into the file list
+    size_t offset;
+    size_t length;
+};
+
+struct Task {
+    vector<Piece> pieces;
+    size_t bytes = 0;
+};
+
+using Counts = unordered_map<string, long long>;
+
+struct WorkerQueue {
+    mutex lock;
+    deque<Task> tasks;
+};
+
+// Adds one file with its size, or skips it with a warning if the size cannot be read
+void add_file(const string& name, uintmax_t size, const error_code& ec, vector<string>& files,
+              vector<size_t>& sizes) {
+    if (ec) {
+        cerr << "Skipping " << name << ": " << ec.message() << "\n";
+        return;
+    }
+    files.push_back(name);
+    sizes.push_back(size);
+}
+
+// Walks one directory and, recursively, its subdirectories (not following
+// symlinks). A directory that cannot be opened or read is reported and the
+// rest of it skipped, without dropping its siblings.
+void walk_directory(const fs::path& dir, vector<string>& files, vector<size_t>& sizes) {
+    error_code ec;
+    fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    if (ec) {
+        cerr << "Skipping directory " << dir.string() << ": " << ec.message() << "\n";
+        return;
+    }
+    for (; it != fs::directory_iterator(); it.increment(ec)) {
+        error_code entry_ec;
+        if (!it->is_symlink(entry_ec) && it->is_directory(entry_ec)) {
+            walk_directory(it->path(), files, sizes);
+        } else if (it->is_regular_file(entry_ec)) {
+            uintmax_t size = it->file_size(entry_ec);
+            add_file(it->path().string(), size, entry_ec, files, sizes);
+        }
+    }
+    // A failed increment leaves the iterator at the end, so the loop stops there
+    if (ec) cerr << "Stopped reading directory " << dir.string() << " early: " << ec.message() << "\n";
+}
+
+void collect_files(const string& path, vector<string>& files, vector<size_t>& sizes) {
+    error_code ec;
+    if (fs::is_directory(path, ec)) {
+        walk_directory(path, files, sizes);
+    } else if (fs::is_regular_file(path, ec)) {
+        uintmax_t size = fs::file_size(path, ec);
+        add_file(path, size, ec, files, sizes);
+    } else {
+        cerr << "Skipping " << path << ": not a file or directory\n";
+    }
+}
+
+// Split a large file into pieces of ~CHUNK_BYTES whose boundaries fall on whitespace,
+// so no word is counted twice or cut in half.
+void split_large_file(int file, const string& name, size_t size, vector<Task>& tasks) {
+    ifstream in(name, ios::binary);
+    size_t start = 0;
+    while (start < size) {
+        size_t end = min(size, start + CHUNK_BYTES);
+        if (end < size) {
+            in.seekg(end);
+            char c;
+            while (in.get(c) && !isspace(static_cast<unsigned char>(c))) ++end;
+            in.clear();
+        }
+        Task t;
+        t.pieces.push_back({file, start, end - start});
+        t.bytes = end - start;
+        tasks.push_back(std::move(t));
+        start = end;
+    }
+}
+
+vector<Task> plan_tasks(const vector<string>& files, const vector<size_t>& sizes) {
+    vector<Task> tasks;
+    Task batch;
+    for (int f = 0; f < static_cast<int>(files.size()); ++f) {
+        if (sizes[f] == 0) continue;
+        if (sizes[f] >= CHUNK_BYTES) {
+            split_large_file(f, files[f], sizes[f], tasks);
+            continue;
+        }
+        batch.pieces.push_back({f, 0, sizes[f]});
+        batch.bytes += sizes[f];
+        if (batch.bytes >= CHUNK_BYTES || batch.pieces.size() >= MAX_FILES_PER_BATCH) {
+            tasks.push_back(std::move(batch));
+            batch = Task();
+        }
+    }
+    if (!batch.pieces.empty()) tasks.push_back(std::move(batch));
+
+    // Largest first, so the tail of the schedule is made of small tasks
+    sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) { return a.bytes > b.bytes; });
+    return tasks;
+}
+
+void count_buffer(const string& text, Counts& counts) {
+    string cleaned;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        char c = i < text.size() ? text[i] : ' ';
+        if (isspace(static_cast<unsigned char>(c))) {
+            if (!cleaned.empty()) {
+                counts[cleaned]++;
+                cleaned.clear();
+            }
+        } else if (isalpha(static_cast<unsigned char>(c))) {
+            cleaned += tolower(c);
+        }
+    }
+}
+
+bool pop_own(WorkerQueue& q, Task& out) {
+    lock_guard<mutex> g(q.lock);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool steal(WorkerQueue& q, Task& out) {
+    lock_guard<mutex> g(q.lock);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool per_file = false;
+    int nthreads = omp_get_max_threads();
+    vector<string> paths;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-p") per_file = true;
+        else if (arg == "-t" && i + 1 < argc) nthreads = max(1, stoi(argv[++i]));
+        else paths.push_back(arg);
+    }
+    if (paths.empty()) paths.push_back("input.txt");
+
+    auto total_start = chrono::high_resolution_clock::now();
+
+    // Planning phase
+    auto plan_start = chrono::high_resolution_clock::now();
+    vector<string> files;
+    vector<size_t> sizes;
+    for (const auto& p : paths) collect_files(p, files, sizes);
+    vector<Task> tasks = plan_tasks(files, sizes);
+    size_t total_bytes = 0;
+    for (const auto& t : tasks) total_bytes += t.bytes;
+
+    vector<WorkerQueue> queues(nthreads);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % nthreads].tasks.push_back(std::move(tasks[i]));
+    }
+    auto plan_end = chrono::high_resolution_clock::now();
+
+    // Counting phase
+    auto comp_start = chrono::high_resolution_clock::now();
+    vector<Counts> local_counts(nthreads);
+    vector<unordered_map<int, Counts>> local_file_counts(nthreads);
+    vector<double> busy(nthreads, 0.0);
+    vector<int> executed(nthreads, 0), stolen(nthreads, 0);
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int tid = omp_get_thread_num();
+        int nq = queues.size();
+        string text;
+        Task task;
+
+        while (true) {
+            bool got = pop_own(queues[tid], task);
+            for (int k = 1; !got && k < nq; ++k) {
+                got = steal(queues[(tid + k) % nq], task);
+                if (got) stolen[tid]++;
+            }
+            // Tasks never spawn tasks, so all deques empty means we are done
+            if (!got) break;
+
+            double t0 = omp_get_wtime();
+            for (const auto& piece : task.pieces) {
+                ifstream in(files[piece.file], ios::binary);
+                text.resize(piece.length);
+                in.seekg(piece.offset);
+                in.read(&text[0], piece.length);
+                text.resize(in.gcount());
+                count_buffer(text, per_file ? local_file_counts[tid][piece.file] : local_counts[tid]);
+            }
+            busy[tid] += omp_get_wtime() - t0;
+            executed[tid]++;
+        }
+    }
+    auto comp_end = chrono::high_resolution_clock::now();
+
+    // Reduction phase
+    auto reduce_start = chrono::high_resolution_clock::now();
+    vector<Counts> file_counts(per_file ? files.size() : 0);
+    if (per_file) {
+        // Chunks of one file may have run on several threads
+        for (auto& lfc : local_file_counts) {
+            for (auto& [f, counts] : lfc) {
+                for (const auto& [word, count] : counts) {
+                    file_counts[f][word] += count;
+                    local_counts[0][word] += count;
+                }
+            }
+        }
+    }
+    Counts global_counts = std::move(local_counts[0]);
+    for (int t = 1; t < nthreads; ++t) {
+        for (const auto& [word, count] : local_counts[t]) {
+            global_counts[word] += count;
+        }
+    }
+    auto reduce_end = chrono::high_resolution_clock::now();
+    auto total_end = chrono::high_resolution_clock::now();
+
+    long long total_words = 0;
+    for (const auto& [word, count] : global_counts) total_words += count;
+
+    ofstream out("wc_counts.txt");
+    for (const auto& [word, count] : global_counts) out << word << " " << count << "\n";
+    if (per_file) {
+        ofstream pf("wc_per_file_counts.txt");
+        for (size_t f = 0; f < files.size(); ++f) {
+            for (const auto& [word, count] : file_counts[f]) {
+                pf << files[f] << "\t" << word << "\t" << count << "\n";
+            }
+        }
+    }
+
+    chrono::duration<double> plan_time = plan_end - plan_start;
+    chrono::duration<double> comp_time = comp_end - comp_start;
+    chrono::duration<double> reduce_time = reduce_end - reduce_start;
+    chrono::duration<double> total_time = total_end - total_start;
+
+    cout << "Files              : " << files.size() << " (" << total_bytes << " bytes, "
+         << queues.size() << " threads)\n";
+    cout << "Words              : " << total_words << " (" << global_counts.size() << " distinct)\n";
+    cout << "Planning Time      : " << plan_time.count() << " seconds\n";
+    cout << "Computation Time   : " << comp_time.count() << " seconds\n";
+    cout << "Reduction Time     : " << reduce_time.count() << " seconds\n";
+    cout << "Total Execution Time: " << total_time.count() << " seconds\n";
+    for (int t = 0; t < nthreads; ++t) {
+        cout << "Thread " << t << " busy " << busy[t] << " s, tasks " << executed[t]
+             << ", stolen " << stolen[t] << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+// Approximate top-K word count using per-thread Count-Min + Space-Saving sketches.
+//
+// Each thread summarises its slice of the word stream in constant memory:
+//   - a Count-Min sketch (DEPTH x WIDTH counters) giving an upper-bound estimate
+//     for any word, with overestimate <= eps * N with probability 1 - delta
+//   - a Space-Saving summary of K counters giving the heavy hitters, where every
+//     reported count c has a known maximum overestimate err (true >= c - err)
+// The sketches are mergeable, so the reduction is a fixed-size combine instead of
+// the word-by-word hash map merge in parallel_WC.cpp. The exact hash map path is
+// run as well so that speed and accuracy can be compared.
+//
+// Usage: ./cpp_sketch_WC [input_file] [top_k] [summary_size]
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <omp.h>
+#include <cctype>
+#include <chrono>
+
+using namespace std;
+
+const int CM_DEPTH = 4;                   // delta = e^-4 ~ 1.8%
+const int CM_WIDTH_BITS = 14;
+const int CM_WIDTH = 1 << CM_WIDTH_BITS;  // eps = e / 16384 ~ 1.7e-4
+
+vector<string> split_to_words(const string& text) {
+    istringstream iss(text);
+    string word;
+    vector<string> words;
+    while (iss >> word) {
+        string cleaned;
+        for (char c : word) {
+            if (isalpha(c)) cleaned += tolower(c);
+        }
+        if (!cleaned.empty()) words.push_back(cleaned);
+    }
+    return words;
+}
+
+// 64-bit FNV-1a; the row hashes are derived from it with a multiply-shift per row
+inline uint64_t hash_word(const string& w) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : w) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+struct CountMin {
+    vector<uint32_t> table;
+    uint64_t total = 0;
+
+    CountMin() : table(CM_DEPTH * CM_WIDTH, 0) {}
+
+    static inline uint32_t column(uint64_t h, int row) {
+        static const uint64_t seeds[CM_DEPTH] = {
+            0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+            0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+        return static_cast<uint32_t>(((h ^ (h >> 29)) * seeds[row]) >> (64 - CM_WIDTH_BITS));
+    }
+
+    void add(uint64_t h, uint32_t count = 1) {
+        for (int r = 0; r < CM_DEPTH; ++r) {
+            table[r * CM_WIDTH + column(h, r)] += count;
+        }
+        total += count;
+    }
+
+    uint32_t estimate(uint64_t h) const {
+        uint32_t best = UINT32_MAX;
+        for (int r = 0; r < CM_DEPTH; ++r) {
+            best = min(best, table[r * CM_WIDTH + column(h, r)]);
+        }
+        return best;
+    }
+
+    void merge(const CountMin& other) {
+        for (size_t i = 0; i < table.size(); ++i) table[i] += other.table[i];
+        total += other.total;
+    }
+
+    // Additive error bound eps * N, holding with probability 1 - e^-DEPTH
+    double error_bound() const {
+        return exp(1.0) / CM_WIDTH * static_cast<double>(total);
+    }
+};
+
+// Space-Saving summary with K counters kept in an indexed min-heap on count.
+struct SpaceSaving {
+    struct Counter {
+        string word;
+        uint64_t count;
+        uint64_t err;
+    };
+
+    size_t capacity;
+    vector<Counter> heap;
+    unordered_map<string, size_t> pos;
+
+    explicit SpaceSaving(size_t k) : capacity(k) {
+        heap.reserve(k);
+        pos.reserve(2 * k);
+    }
+
+    void swap_nodes(size_t a, size_t b) {
+        swap(heap[a], heap[b]);
+        pos[heap[a].word] = a;
+        pos[heap[b].word] = b;
+    }
+
+    void sift_down(size_t i) {
+        size_t n = heap.size();
+        while (true) {
+            size_t l = 2 * i + 1, r = l + 1, smallest = i;
+            if (l < n && heap[l].count < heap[smallest].count) smallest = l;
+            if (r < n && heap[r].count < heap[smallest].count) smallest = r;
+            if (smallest == i) return;
+            swap_nodes(i, smallest);
+            i = smallest;
+        }
+    }
+
+    void sift_up(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (heap[parent].count <= heap[i].count) return;
+            swap_nodes(i, parent);
+            i = parent;
+        }
+    }
+
+    void add(const string& word, uint64_t count = 1, uint64_t err = 0) {
+        auto it = pos.find(word);
+        if (it != pos.end()) {
+            heap[it->second].count += count;
+            heap[it->second].err += err;
+            sift_down(it->second);
+        } else if (heap.size() < capacity) {
+            heap.push_back({word, count, err});
+            pos[word] = heap.size() - 1;
+            sift_up(heap.size() - 1);
+        } else {
+            // Evict the minimum: the newcomer inherits its count as potential error
+            uint64_t min_count = heap[0].count;
+            pos.erase(heap[0].word);
+            heap[0] = {word, min_count + count, min_count + err};
+            pos[word] = 0;
+            sift_down(0);
+        }
+    }
+
+    uint64_t min_count() const {
+        return heap.size() < capacity ? 0 : heap[0].count;
+    }
+
+    // Mergeable summaries (Agarwal et al.): a word missing from one side may have
+    // occurred up to that side's minimum count times, so it is charged as error.
+    void merge(const SpaceSaving& other) {
+        uint64_t my_min = min_count();
+        uint64_t other_min = other.min_count();
+
+        unordered_map<string, Counter> combined;
+        combined.reserve(heap.size() + other.heap.size());
+        for (const auto& c : heap) {
+            combined[c.word] = {c.word, c.count + other_min, c.err + other_min};
+        }
+        for (const auto& c : other.heap) {
+            auto it = combined.find(c.word);
+            if (it != combined.end()) {
+                it->second.count += c.count - other_min;
+                it->second.err += c.err - other_min;
+            } else {
+                combined[c.word] = {c.word, c.count + my_min, c.err + my_min};
+            }
+        }
+
+        vector<Counter> all;
+        all.reserve(combined.size());
+        for (auto& [w, c] : combined) all.push_back(std::move(c));
+        if (all.size() > capacity) {
+            nth_element(all.begin(), all.begin() + capacity, all.end(),
+                        [](const Counter& a, const Counter& b) { return a.count > b.count; });
+            all.resize(capacity);
+        }
+
+        heap = std::move(all);
+        pos.clear();
+        for (size_t i = 0; i < heap.size(); ++i) pos[heap[i].word] = i;
+        for (size_t i = heap.size() / 2; i-- > 0;) sift_down(i);
+    }
+
+    vector<Counter> top(size_t k) const {
+        vector<Counter> sorted = heap;
+        sort(sorted.begin(), sorted.end(),
+             [](const Counter& a, const Counter& b) { return a.count > b.count; });
+        if (sorted.size() > k) sorted.resize(k);
+        return sorted;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    string filename = argc > 1 ? argv[1] : "input.txt";
+    size_t top_k = argc > 2 ? stoul(argv[2]) : 10;
+    size_t summary_size = argc > 3 ? stoul(argv[3]) : max<size_t>(256, 8 * top_k);
+
+    // File reading and splitting (shared by both paths)
+    auto file_read_start = chrono::high_resolution_clock::now();
+    ifstream infile(filename);
+    if (!infile) {
+        cerr << "Could not open " << filename << "\n";
+        return 1;
+    }
+    stringstream buffer;
+    buffer << infile.rdbuf();
+    vector<string> words = split_to_words(buffer.str());
+    auto file_read_end = chrono::high_resolution_clock::now();
+
+    int n = words.size();
+    int nthreads = omp_get_max_threads();
+
+    // Exact path: per-thread hash maps merged into global_counts
+    auto exact_start = chrono::high_resolution_clock::now();
+    vector<unordered_map<string, int>> local_counts(nthreads);
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int chunk_size = (n + nthreads - 1) / nthreads;
+        int start = tid * chunk_size;
+        int end = min(n, (tid + 1) * chunk_size);
+
+        for (int i = start; i < end; ++i) {
+            local_counts[tid][words[i]]++;
+        }
+    }
+    unordered_map<string, int> global_counts;
+    for (const auto& lc : local_counts) {
+        for (const auto& [word, count] : lc) {
+            global_counts[word] += count;
+        }
+    }
+    vector<pair<string, int>> exact_top(global_counts.begin(), global_counts.end());
+    size_t exact_k = min(top_k, exact_top.size());
+    partial_sort(exact_top.begin(), exact_top.begin() + exact_k, exact_top.end(),
+                 [](const auto& a, const auto& b) { return a.second > b.second; });
+    exact_top.resize(exact_k);
+    auto exact_end = chrono::high_resolution_clock::now();
+
+    // Sketch path: constant memory per thread, fixed-size merge
+    auto sketch_start = chrono::high_resolution_clock::now();
+    vector<CountMin> cms(nthreads);
+    vector<SpaceSaving> sss(nthreads, SpaceSaving(summary_size));
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        int chunk_size = (n + nthreads - 1) / nthreads;
+        int start = tid * chunk_size;
+        int end = min(n, (tid + 1) * chunk_size);
+
+        for (int i = start; i < end; ++i) {
+            cms[tid].add(hash_word(words[i]));
+            sss[tid].add(words[i]);
+        }
+    }
+    auto sketch_comp_end = chrono::high_resolution_clock::now();
+
+    for (int t = 1; t < nthreads; ++t) {
+        cms[0].merge(cms[t]);
+        sss[0].merge(sss[t]);
+    }
+    auto sketch_top = sss[0].top(top_k);
+    auto sketch_end = chrono::high_resolution_clock::now();
+
+    // Accuracy against the exact counts
+    unordered_set<string> exact_set;
+    for (const auto& [word, count] : exact_top) exact_set.insert(word);
+    size_t hits = 0;
+    double rel_err_ss = 0.0, rel_err_cm = 0.0;
+    bool bounds_hold = true;
+
+    cout << "Top-" << top_k << " (Space-Saving, " << summary_size << " counters; Count-Min "
+         << CM_DEPTH << "x" << CM_WIDTH << ")\n";
+    cout << left << setw(16) << "word" << right << setw(10) << "exact" << setw(10) << "ss"
+         << setw(10) << "ss_err" << setw(10) << "cm" << "\n";
+    for (const auto& c : sketch_top) {
+        auto it = global_counts.find(c.word);
+        int exact = it == global_counts.end() ? 0 : it->second;
+        uint32_t cm = cms[0].estimate(hash_word(c.word));
+        if (exact_set.count(c.word)) hits++;
+        if (exact > 0) {
+            rel_err_ss += fabs(static_cast<double>(c.count) - exact) / exact;
+            rel_err_cm += fabs(static_cast<double>(cm) - exact) / exact;
+        }
+        if (static_cast<uint64_t>(exact) > c.count || static_cast<uint64_t>(exact) + c.err < c.count ||
+            static_cast<uint32_t>(exact) > cm) {
+            bounds_hold = false;
+        }
+        cout << left << setw(16) << c.word << right << setw(10) << exact << setw(10) << c.count
+             << setw(10) << c.err << setw(10) << cm << "\n";
+    }
+
+    chrono::duration<double> file_read_time = file_read_end - file_read_start;
+    chrono::duration<double> exact_time = exact_end - exact_start;
+    chrono::duration<double> sketch_comp_time = sketch_comp_end - sketch_start;
+    chrono::duration<double> sketch_time = sketch_end - sketch_start;
+    size_t reported = max<size_t>(1, sketch_top.size());
+
+    cout << "\nWords              : " << n << " (" << global_counts.size() << " distinct)\n";
+    cout << "File Read Time     : " << file_read_time.count() << " seconds\n";
+    cout << "Exact Time         : " << exact_time.count() << " seconds\n";
+    cout << "Sketch Update Time : " << sketch_comp_time.count() << " seconds\n";
+    cout << "Sketch Total Time  : " << sketch_time.count() << " seconds\n";
+    cout << "Top-K Recall       : " << hits << "/" << exact_k << "\n";
+    cout << "Mean Rel. Err (SS) : " << rel_err_ss / reported << "\n";
+    cout << "Mean Rel. Err (CM) : " << rel_err_cm / reported << "\n";
+    cout << "CM Error Bound     : " << cms[0].error_bound() << " (p >= " << 1.0 - exp(-CM_DEPTH) << ")\n";
+    cout << "Bounds Hold        : " << (bounds_hold ? "yes" : "no") << "\n";
+
+    return 0;
+}
@@ -1,16 +1,26 @@
 #include <iostream>
 #include <vector>
-#include <fstream>
 #include <complex>
 #include <thread>
 #include <chrono>
+#include <string>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include "mandelbrot_simd.h"
+#include "mandelbrot_schedule.h"
+#include "mandelbrot_image.h"
+#include "mandelbrot_deep.h"
+#include "mandelbrot_progressive.h"
 
 // Image and Mandelbrot parameters
 const int WIDTH = 1600;
 const int HEIGHT = 1200;
 const double ZOOM = 300.0;
 const int MAX_ITER = 1000;
-const int NUM_THREADS = 8; // Number of worker threads for parallelism
+const int TILE_WIDTH = 64;  // Tiles handed to the worker threads one at a time
+const int TILE_HEIGHT = 16;
 
 // Mandelbrot iteration function: returns number of iterations before escape
 int mandelbrot(double x, double y) {
@@ -26,52 +36,378 @@ int mandelbrot(double x, double y) {
     return iter; // Return iteration count (used for color mapping)
 }
 
-// Thread worker: computes rows [start, end) and stores in 'result'
-void compute_rows(int start, int end, std::vector<std::vector<int>>& result) {
-    for (int py = start; py < end; ++py) {
-        std::vector<int> row(WIDTH); // Create row buffer
-        for (int px = 0; px < WIDTH; ++px) {
-            // Convert pixel to complex plane coordinates
-            double x = static_cast<double>(px) / ZOOM - 2.0;
-            double y = static_cast<double>(py) / ZOOM - 1.5;
-            row[px] = mandelbrot(x, y); // Compute iteration count
+// Pixels [x0, x1) x [y0, y1) of the image, stored in 'result'.
+// lanes == 0 runs mandelbrot() per pixel, otherwise the SIMD kernel (mandelbrot_simd.h),
+// with the interior shortcuts (cardioid/bulb tests, cycle detection) if asked
+void compute_block(int x0, int y0, int x1, int y1, Image& result, SimdIsa isa, int lanes,
+                   bool interior = false) {
+    double xs[WIDTH], ys[WIDTH];
+    for (int px = x0; px < x1; ++px) {
+        xs[px - x0] = static_cast<double>(px) / ZOOM - 2.0; // Real part is the same on every row
+    }
+    for (int py = y0; py < y1; ++py) {
+        double y = static_cast<double>(py) / ZOOM - 1.5;
+        if (lanes == 0) {
+            for (int px = x0; px < x1; ++px) {
+                result[py][px] = mandelbrot(xs[px - x0], y); // Compute iteration count
+            }
+        } else {
+            std::fill(ys, ys + (x1 - x0), y);
+            escapeCounts(xs, ys, &result[py][x0], x1 - x0, MAX_ITER, isa, lanes, interior); // W pixels at a time
         }
-        result[py] = std::move(row); // Store row in result vector
     }
 }
 
-int main() {
-    std::vector<std::vector<int>> result(HEIGHT); // Stores the full image data
-    std::vector<std::thread> threads;             // Container for thread objects
+// Pixel column px, rows [y0, y1), with the interior shortcuts
+void compute_column(int px, int y0, int y1, Image& result, SimdIsa isa, int lanes) {
+    double xs[HEIGHT] = {}, ys[HEIGHT] = {};  // only [0, y1 - y0) is read, but GCC cannot tell
+    int counts[HEIGHT];
+    for (int py = y0; py < y1; ++py) {
+        xs[py - y0] = static_cast<double>(px) / ZOOM - 2.0;
+        ys[py - y0] = static_cast<double>(py) / ZOOM - 1.5;
+    }
+    escapeCounts(xs, ys, counts, y1 - y0, MAX_ITER, isa, lanes, true);
+    for (int py = y0; py < y1; ++py) result[py][px] = counts[py - y0];
+}
 
-    auto start_time = std::chrono::high_resolution_clock::now(); // Start timing
+// Mariani-Silver subdivision of [x0, x1) x [y0, y1), whose border pixels are
+// already computed. A border entirely at MAX_ITER encloses only points of the
+// set (the set is connected and has no holes), so the inside is filled without
+// iterating; otherwise the rectangle is cut in two along its longer side, the
+// cut line is computed, and both halves go the same way. Small rectangles are
+// computed directly. Borders of other uniform counts are not filled: thin
+// filaments of the set can cross them between pixels and change the counts.
+void subdivide(int x0, int y0, int x1, int y1, Image& result, SimdIsa isa, int lanes) {
+    if (x1 - x0 <= 2 || y1 - y0 <= 2) return; // No interior pixels
+    bool inside = true;
+    for (int px = x0; px < x1 && inside; ++px) {
+        inside = result[y0][px] == MAX_ITER && result[y1 - 1][px] == MAX_ITER;
+    }
+    for (int py = y0; py < y1 && inside; ++py) {
+        inside = result[py][x0] == MAX_ITER && result[py][x1 - 1] == MAX_ITER;
+    }
+    if (inside) {
+        for (int py = y0 + 1; py < y1 - 1; ++py) {
+            std::fill(&result[py][x0 + 1], &result[py][x1 - 1], MAX_ITER);
+        }
+        return;
+    }
+    if ((x1 - x0) * (y1 - y0) <= 64) {
+        compute_block(x0 + 1, y0 + 1, x1 - 1, y1 - 1, result, isa, lanes, true);
+        return;
+    }
+    if (x1 - x0 >= y1 - y0) {
+        int xm = (x0 + x1) / 2;
+        compute_column(xm, y0 + 1, y1 - 1, result, isa, lanes);
+        subdivide(x0, y0, xm + 1, y1, result, isa, lanes);
+        subdivide(xm, y0, x1, y1, result, isa, lanes);
+    } else {
+        int ym = (y0 + y1) / 2;
+        compute_block(x0 + 1, ym, x1 - 1, ym + 1, result, isa, lanes, true);
+        subdivide(x0, y0, x1, ym + 1, result, isa, lanes);
+        subdivide(x0, ym, x1, y1, result, isa, lanes);
+    }
+}
+
+// One tile by Mariani-Silver: its border, then subdivide()
+void compute_tile_mariani_silver(int x0, int y0, int x1, int y1, Image& result, SimdIsa isa,
+                                 int lanes) {
+    compute_block(x0, y0, x1, y0 + 1, result, isa, lanes, true);
+    compute_block(x0, y1 - 1, x1, y1, result, isa, lanes, true);
+    compute_column(x0, y0 + 1, y1 - 1, result, isa, lanes);
+    compute_column(x1 - 1, y0 + 1, y1 - 1, result, isa, lanes);
+    subdivide(x0, y0, x1, y1, result, isa, lanes);
+}
 
-    // Divide work among threads (each thread processes a block of rows)
-    int rows_per_thread = HEIGHT / NUM_THREADS;
-    for (int i = 0; i < NUM_THREADS; ++i) {
-        int start = i * rows_per_thread;
-        int end = (i == NUM_THREADS - 1) ? HEIGHT : start + rows_per_thread;
-        threads.emplace_back(compute_rows, start, end, std::ref(result)); // Launch thread
+enum class Schedule { StaticRows, DynamicTiles };
+
+// How each pixel's count is found: the plain escape loop, the loop with the
+// interior shortcuts, or Mariani-Silver subdivision of each tile on top of them.
+// All three give the same counts.
+enum class Method { BruteForce, Interior, MarianiSilver };
+
+const char* method_name(Method method) {
+    switch (method) {
+        case Method::Interior: return "interior checks";
+        case Method::MarianiSilver: return "Mariani-Silver";
+        default: return "brute force";
     }
+}
+
+// Computes the full image on 'threads' threads, either as one contiguous block
+// of rows per thread or as TILE_WIDTH x TILE_HEIGHT tiles handed out one at a
+// time from a shared counter (mandelbrot_schedule.h). Returns the elapsed
+// seconds; 'stats' gets each thread's busy time. With tiles, a 'streamer' is
+// told of every finished tile, its band being its row of tiles.
+double compute_image(Image& result, SimdIsa isa, int lanes, Method method, Schedule schedule, int threads,
+                     std::vector<ThreadStats>* stats = nullptr, BandStreamer* streamer = nullptr) {
+    bool interior = method != Method::BruteForce;
+    result.clear();
 
-    // Wait for all threads to complete
-    for (auto& t : threads) {
-        t.join();
+    auto start_time = std::chrono::high_resolution_clock::now(); // Start timing
+
+    std::vector<ThreadStats> perThread;
+    if (schedule == Schedule::StaticRows) {
+        perThread = runStatic(HEIGHT, threads, [&](int py) {
+            compute_block(0, py, WIDTH, py + 1, result, isa, lanes, interior);
+        });
+    } else {
+        const int tilesX = (WIDTH + TILE_WIDTH - 1) / TILE_WIDTH;
+        const int tilesY = (HEIGHT + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        perThread = runDynamic(tilesX * tilesY, threads, [&](int tile) {
+            int x0 = tile % tilesX * TILE_WIDTH, y0 = tile / tilesX * TILE_HEIGHT;
+            int x1 = std::min(x0 + TILE_WIDTH, WIDTH), y1 = std::min(y0 + TILE_HEIGHT, HEIGHT);
+            if (method == Method::MarianiSilver) compute_tile_mariani_silver(x0, y0, x1, y1, result, isa, lanes);
+            else compute_block(x0, y0, x1, y1, result, isa, lanes, interior);
+            if (streamer) streamer->tileDone(tile / tilesX);
+        });
     }
 
     auto end_time = std::chrono::high_resolution_clock::now(); // End timing
     std::chrono::duration<double> elapsed = end_time - start_time;
-    std::cout << "Computation Time: " << elapsed.count() << " seconds\n";
+    if (stats) *stats = perThread;
+    return elapsed.count();
+}
+
+// One line per thread, then the slowest thread against the average
+void print_balance(const std::vector<ThreadStats>& stats) {
+    double total = 0.0, slowest = 0.0;
+    for (size_t t = 0; t < stats.size(); ++t) {
+        std::cout << "  thread " << t << ": busy " << stats[t].busySeconds << " s, " << stats[t].tasks << " tasks\n";
+        total += stats[t].busySeconds;
+        slowest = std::max(slowest, stats[t].busySeconds);
+    }
+    std::cout << "  slowest / mean busy time: " << slowest / (total / stats.size()) << "\n";
+}
+
+// Old static row blocks against dynamic tiles with the same thread count
+int balance(int threads) {
+    Image reference(WIDTH, HEIGHT), result(WIDTH, HEIGHT);
+    SimdIsa isa = detectIsa();
+    std::vector<ThreadStats> stats;
+    double seconds = compute_image(reference, isa, wideLanes(isa), Method::Interior, Schedule::StaticRows, threads, &stats);
+    std::cout << "Static row blocks, " << threads << " threads: " << seconds << " seconds\n";
+    print_balance(stats);
+    seconds = compute_image(result, isa, wideLanes(isa), Method::Interior, Schedule::DynamicTiles, threads, &stats);
+    std::cout << "Dynamic " << TILE_WIDTH << "x" << TILE_HEIGHT << " tiles, " << threads << " threads: " << seconds
+              << " seconds\n";
+    print_balance(stats);
+    return result == reference ? 0 : 1;
+}
+
+// Writes 'image' (no count above max_value) as PGM and reads it back: header,
+// sample width (1 byte below 256, else 2) and every value
+bool pgm_round_trip(const Image& image, int max_value) {
+    const std::string path = "mandelbrot_check.pgm";
+    ImageWriter writer(path, ImageFormat::Pgm, image.width(), image.height(), max_value, 1);
+    writer.writeRows(image[0], image.height());
+    writer.finish();
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path.c_str());
+    std::string header = "P5\n" + std::to_string(image.width()) + " " + std::to_string(image.height()) + "\n" +
+                         std::to_string(max_value) + "\n";
+    size_t sample = max_value < 256 ? 1 : 2;
+    if (bytes.compare(0, header.size(), header) != 0 ||
+        bytes.size() != header.size() + sample * image.width() * image.height()) {
+        return false;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes.data()) + header.size();
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x) {
+            size_t at = sample * (size_t(y) * image.width() + x);
+            int v = sample == 1 ? data[at] : data[at] << 8 | data[at + 1];
+            if (v != image[y][x]) return false;
+        }
+    }
+    return true;
+}
 
-    // Write the output to a CSV file
-    std::ofstream out("mandelbrot_output.csv");
-    for (const auto& row : result) {
-        for (size_t i = 0; i < row.size(); ++i) {
-            out << row[i] << (i + 1 == row.size() ? "\n" : ","); // Format CSV
+// Times the per-pixel loop, every SIMD kernel this CPU has and the interior
+// methods, and checks that they all give the same iteration counts
+int check() {
+    Image reference(WIDTH, HEIGHT), result(WIDTH, HEIGHT);
+    int threads = workerThreads();
+    double seconds = compute_image(reference, SimdIsa::Scalar, 0, Method::BruteForce, Schedule::DynamicTiles, threads);
+    std::cout << "scalar std::complex : " << seconds << " seconds\n";
+    bool same = true;
+    auto report = [&](const std::string& name) {
+        long long differing = 0;
+        for (int py = 0; py < HEIGHT; ++py) {
+            for (int px = 0; px < WIDTH; ++px) differing += result[py][px] != reference[py][px];
+        }
+        same = same && differing == 0;
+        std::cout << name << std::string(name.size() < 20 ? 20 - name.size() : 1, ' ') << ": " << seconds << " seconds";
+        if (differing) std::cout << "  MISMATCH in " << differing << " pixels";
+        std::cout << "\n";
+    };
+    for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512}) {
+        if (!isaSupported(isa)) continue;
+        for (int lanes : {narrowLanes(isa), wideLanes(isa)}) {
+            if (isa == SimdIsa::Scalar && lanes > 1) continue;
+            seconds = compute_image(result, isa, lanes, Method::BruteForce, Schedule::DynamicTiles, threads);
+            report(std::string(isaName(isa)) + " x" + std::to_string(lanes));
         }
     }
-    out.close();
-    std::cout << "Output saved to mandelbrot_output.csv\n";
+    SimdIsa best = detectIsa();
+    for (Method method : {Method::Interior, Method::MarianiSilver}) {
+        for (SimdIsa isa : {SimdIsa::Scalar, best}) {
+            seconds = compute_image(result, isa, wideLanes(isa), method, Schedule::DynamicTiles, threads);
+            report(std::string(isaName(isa)) + ", " + method_name(method));
+        }
+    }
+    std::cout << (same ? "Iteration counts identical\n" : "Iteration counts differ\n");
+
+    // PGM output for a maxval that needs 1-byte samples and one that needs 2
+    bool pgm_ok = true;
+    for (int max_value : {200, MAX_ITER}) {
+        Image clipped(WIDTH, HEIGHT);
+        for (int py = 0; py < HEIGHT; ++py) {
+            for (int px = 0; px < WIDTH; ++px) clipped[py][px] = std::min(reference[py][px], max_value);
+        }
+        pgm_ok = pgm_ok && pgm_round_trip(clipped, max_value);
+    }
+    std::cout << (pgm_ok ? "PGM output ok\n" : "PGM output WRONG\n");
+    return same && pgm_ok ? 0 : 1;
+}
+
+// Deep zoom by perturbation (mandelbrot_deep.h): args are re im magnification
+// [max_iter [output file]], the centre given in as many decimal digits as the
+// magnification needs and the magnification relative to the default view
+int deep(int argc, char* argv[]) {
+    std::string re = argc > 0 ? argv[0] : "-0.743643887037158704752191506114774";
+    std::string im = argc > 1 ? argv[1] : "0.131825904205311970493132056385139";
+    double magnification = argc > 2 ? std::stod(argv[2]) : 1e15;
+    int max_iter = argc > 3 ? std::stoi(argv[3]) : 5000;
+    std::string path = argc > 4 ? argv[4] : "mandelbrot_deep.png";
+    int threads = workerThreads();
+    SimdIsa isa = detectIsa();
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    PerturbationRenderer renderer(re, im, ZOOM * magnification, max_iter);
+    std::chrono::duration<double> reference_time = std::chrono::high_resolution_clock::now() - start_time;
+    Image result(WIDTH, HEIGHT);
+    DeepStats stats = renderer.render(result, threads, isa);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    std::cout << "Deep zoom x" << magnification << ": " << elapsed.count() << " seconds (reference orbit "
+              << reference_time.count() << " s, " << stats.referenceLength << " iterations; series skipped "
+              << stats.skipped << "; " << stats.rebases << " rebases; " << isaName(isa) << " kernel, " << threads
+              << " threads)\n";
+
+    // Spot check against plain high-precision iteration of a few pixels. Pixels
+    // on the boundary with high counts are chaotic, so an odd one may be off.
+    int matching = 0, samples = 16;
+    for (int k = 0; k < samples; ++k) {
+        int px = (2 * k + 1) * WIDTH / (2 * samples), py = (k * 7 % samples) * HEIGHT / samples;
+        auto c = renderer.point(px, py, WIDTH, HEIGHT);
+        matching += directCount(c.first, c.second, max_iter) == result[py][px];
+    }
+    std::cout << matching << " of " << samples << " sampled pixels match direct high-precision iteration\n";
+
+    ImageWriter writer(path, formatOf(path), WIDTH, HEIGHT, max_iter, threads);
+    writer.writeRows(result[0], HEIGHT);
+    writer.finish();
+    std::cout << "Output saved to " << path << "\n";
+    return 0;
+}
+
+// A pan and zoom sequence through the progressive renderer and its tile cache
+// (mandelbrot_progressive.h): per frame, the time to the first coarse pass and
+// to the exact image, and how many lattice points had to be iterated (the
+// coarse passes also take a few just left of or above the view). Every frame is
+// checked against the plain loop.
+int progressive() {
+    TileCache cache;
+    ProgressiveRenderer renderer(cache);
+    SimdIsa isa = detectIsa();
+    Viewport view{-0.5, 0.0, ZOOM, WIDTH, HEIGHT, MAX_ITER};
+    std::vector<Viewport> frames;
+    for (int k = 0; k < 4; ++k, view.centerX += 160 / view.pixelsPerUnit) frames.push_back(view);  // pan right
+    for (int k = 0; k < 4; ++k, view.pixelsPerUnit *= 2) frames.push_back(view);                    // zoom in
+    frames.push_back(frames[0]);                                                                   // back to the start
+
+    // The frame's lattice points straight through the plain kernel
+    auto matches_plain = [&](const Viewport& frame, const Image& image) {
+        std::vector<double> xs(WIDTH), ys(WIDTH);
+        std::vector<int> counts(WIDTH);
+        for (int px = 0; px < WIDTH; ++px) xs[px] = (frame.originX() + px) / frame.pixelsPerUnit;
+        for (int py = 0; py < HEIGHT; ++py) {
+            std::fill(ys.begin(), ys.end(), (frame.originY() + py) / frame.pixelsPerUnit);
+            escapeCounts(xs.data(), ys.data(), counts.data(), WIDTH, MAX_ITER, isa, wideLanes(isa));
+            if (!std::equal(counts.begin(), counts.end(), image[py])) return false;
+        }
+        return true;
+    };
+
+    Image image(WIDTH, HEIGHT);
+    bool same = true;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        FrameStats stats = renderer.render(frames[f], image);
+        bool ok = matches_plain(frames[f], image);
+        same = same && ok;
+        std::cout << "Frame " << f << " (" << frames[f].pixelsPerUnit / ZOOM << "x): first pass " << stats.firstPassSeconds
+                  << " s, done " << stats.seconds << " s, iterated " << stats.computed << " lattice points for "
+                  << WIDTH * HEIGHT << " pixels (" << stats.fromCoarser << " from the coarser zoom)"
+                  << (ok ? "" : ", counts differ") << "\n";
+    }
+    std::cout << cache.size() << " tiles cached\n";
+    std::cout << (same ? "Iteration counts identical\n" : "Iteration counts differ\n");
+    return same ? 0 : 1;
+}
+
+// Usage: ./mandelbrot_cpp [brute | mariani-silver] [output file] [stream]
+//        ./mandelbrot_cpp check | balance [threads] | progressive | deep [re im magnification [max_iter [output file]]]
+// The image is computed with the interior checks unless another method is
+// named, and written to mandelbrot_output.csv unless another file is given; its
+// extension picks the format (.csv, .raw, .pgm, .png, mandelbrot_image.h).
+// 'stream' writes the bands of finished tiles while the rest is computed.
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "check") return check();
+    if (mode == "balance") return balance(argc > 2 ? std::stoi(argv[2]) : workerThreads());
+    if (mode == "progressive") return progressive();
+    if (mode == "deep") return deep(argc - 2, argv + 2);
+    Method method = Method::Interior;
+    std::string path = "mandelbrot_output.csv";
+    bool stream = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "brute") method = Method::BruteForce;
+        else if (arg == "mariani-silver") method = Method::MarianiSilver;
+        else if (arg == "stream") stream = true;
+        else path = arg;
+    }
+
+    Image result(WIDTH, HEIGHT);    // Stores the full image data
+    SimdIsa isa = detectIsa();      // Best kernel of this CPU
+    int threads = workerThreads();  // Hardware threads, or MANDELBROT_THREADS
+    std::vector<ThreadStats> stats;
+    ImageWriter writer(path, formatOf(path), WIDTH, HEIGHT, MAX_ITER, threads);
+
+    if (stream) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        BandStreamer streamer(writer, result, TILE_HEIGHT, (WIDTH + TILE_WIDTH - 1) / TILE_WIDTH);
+        double seconds =
+            compute_image(result, isa, wideLanes(isa), method, Schedule::DynamicTiles, threads, &stats, &streamer);
+        streamer.finish();
+        std::chrono::duration<double> total = std::chrono::high_resolution_clock::now() - start_time;
+        std::cout << "Computation Time: " << seconds << " seconds, written by " << total.count() << " seconds ("
+                  << isaName(isa) << " kernel, " << method_name(method) << ", " << threads << " threads)\n";
+        print_balance(stats);
+    } else {
+        double seconds = compute_image(result, isa, wideLanes(isa), method, Schedule::DynamicTiles, threads, &stats);
+        std::cout << "Computation Time: " << seconds << " seconds (" << isaName(isa) << " kernel, "
+                  << method_name(method) << ", " << threads << " threads)\n";
+        print_balance(stats);
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        writer.writeRows(result[0], HEIGHT);
+        writer.finish();
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        std::cout << "Write Time: " << elapsed.count() << " seconds\n";
+    }
+    std::cout << "Output saved to " << path << "\n";
 
     return 0;
 }
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "mandelbrot_schedule.h"
+#include "mandelbrot_image.h"
+#include "mandelbrot_simd.h"
+
+// Deep-zoom Mandelbrot by perturbation.
+//
+// Doubles run out of bits once a pixel is smaller than about 1e-16 of the
+// coordinates. Perturbation iterates only one point, the reference C at the
+// centre of the view, in high precision (Fixed) and keeps the orbit Z_n as
+// doubles. Every pixel c = C + dc then iterates its offset dz_n = z_n - Z_n in
+// plain doubles, which stays small and precise:
+//     dz_{n+1} = (2 Z_n + dz_n) dz_n + dc
+// The pixel escapes when |Z_n + dz_n| > 2, as in mandelbrot().
+//
+// Series approximation: for the first iterations dz_n is, to within rounding,
+// A_n dc + B_n dc^2 + C_n dc^3, with coefficients from the reference orbit
+// alone, so every pixel starts at iteration 'skip' from that polynomial. skip is
+// the last n at which the cubic term is still negligible against the linear one
+// for the farthest pixel, and at which no pixel can have escaped yet.
+//
+// Glitches: where z_n passes closer to 0 than dz_n, the offset from the
+// reference has lost the precision the reference itself carries (the classic
+// perturbation glitch). The pixel is then rebased: dz becomes the full z and it
+// continues from Z_0 = 0 of the same reference, which is exact since both
+// describe the same point. Running off the end of a reference that escaped
+// early is handled the same way, so one reference serves every pixel.
+//
+// dc is a double, which bounds the magnification at about 1e290 (beyond that
+// the offsets underflow).
+
+// Signed fixed-point number: 'limbs' 64-bit words in two's complement, the
+// most significant one holding the integer part, the others the fraction.
+class Fixed {
+public:
+    explicit Fixed(int limbs = 2) : limb_(limbs, 0) {}
+
+    // Decimal "[-]digits[.digits]", digits beyond the precision truncated
+    static Fixed parse(const std::string& text, int limbs) {
+        Fixed x(limbs);
+        size_t at = text.size() > 0 && (text[0] == '-' || text[0] == '+') ? 1 : 0;
+        size_t point = text.find('.');
+        std::string whole = text.substr(at, point == std::string::npos ? std::string::npos : point - at);
+        std::string frac = point == std::string::npos ? "" : text.substr(point + 1);
+        if (whole.empty() && frac.empty()) throw std::invalid_argument("not a number: " + text);
+        for (char ch : whole + frac) {
+            if (ch < '0' || ch > '9') throw std::invalid_argument("not a number: " + text);
+        }
+        // 0.d1 d2 ... from the last digit: x = (x + d) / 10
+        for (size_t i = frac.size(); i-- > 0;) {
+            x.limb_.back() += frac[i] - '0';
+            x.divide(10);
+        }
+        x.limb_.back() += whole.empty() ? 0 : std::stoull(whole);
+        return text[0] == '-' ? -x : x;
+    }
+
+    static Fixed fromDouble(double v, int limbs) {
+        Fixed x(limbs);
+        double mag = std::fabs(v);
+        for (int i = limbs - 1; i >= 0 && mag > 0.0; --i) {
+            double part = std::floor(std::ldexp(mag, 64 * (limbs - 1 - i)));
+            x.limb_[i] = static_cast<uint64_t>(part);
+            mag -= std::ldexp(part, -64 * (limbs - 1 - i));
+        }
+        return v < 0 ? -x : x;
+    }
+
+    int limbs() const { return static_cast<int>(limb_.size()); }
+    bool negative() const { return limb_.back() >> 63; }
+
+    double toDouble() const {
+        if (negative()) return -(-*this).toDouble();
+        int top = limbs() - 1;
+        while (top > 0 && limb_[top] == 0) --top;
+        double v = std::ldexp(static_cast<double>(limb_[top]), 64 * (top - (limbs() - 1)));
+        if (top > 0) v += std::ldexp(static_cast<double>(limb_[top - 1]), 64 * (top - 1 - (limbs() - 1)));
+        return v;
+    }
+
+    Fixed operator-() const {
+        Fixed r(limbs());
+        unsigned carry = 1;
+        for (int i = 0; i < limbs(); ++i) {
+            uint64_t v = ~limb_[i] + carry;
+            carry = carry && v == 0;
+            r.limb_[i] = v;
+        }
+        return r;
+    }
+
+    Fixed operator+(const Fixed& b) const {
+        Fixed r(limbs());
+        unsigned __int128 carry = 0;
+        for (int i = 0; i < limbs(); ++i) {
+            carry += static_cast<unsigned __int128>(limb_[i]) + b.limb_[i];
+            r.limb_[i] = static_cast<uint64_t>(carry);
+            carry >>= 64;
+        }
+        return r;
+    }
+
+    Fixed operator-(const Fixed& b) const { return *this + -b; }
+
+    // Product truncated to the same precision
+    Fixed operator*(const Fixed& b) const {
+        bool sign = negative() != b.negative();
+        const Fixed x = negative() ? -*this : *this, y = b.negative() ? -b : b;
+        const int n = limbs();
+        std::vector<uint64_t> product(2 * n, 0);
+        for (int i = 0; i < n; ++i) {
+            unsigned __int128 carry = 0;
+            for (int j = 0; j < n; ++j) {
+                carry += static_cast<unsigned __int128>(x.limb_[i]) * y.limb_[j] + product[i + j];
+                product[i + j] = static_cast<uint64_t>(carry);
+                carry >>= 64;
+            }
+            product[i + n] = static_cast<uint64_t>(carry);
+        }
+        Fixed r(n);
+        std::copy(product.begin() + (n - 1), product.begin() + (2 * n - 1), r.limb_.begin());
+        return sign ? -r : r;
+    }
+
+private:
+    std::vector<uint64_t> limb_;  // least significant first
+
+    // Non-negative value divided by a small integer
+    void divide(uint64_t d) {
+        unsigned __int128 rem = 0;
+        for (int i = limbs() - 1; i >= 0; --i) {
+            unsigned __int128 cur = rem << 64 | limb_[i];
+            limb_[i] = static_cast<uint64_t>(cur / d);
+            rem = cur % d;
+        }
+    }
+};
+
+// Fraction limbs for pixels of 1 / pixelsPerUnit: the pixel size plus 96 bits
+// for the rounding the orbit amplifies
+inline int limbsFor(double pixelsPerUnit) {
+    return 1 + static_cast<int>(std::ceil((std::log2(std::max(pixelsPerUnit, 1.0)) + 96) / 64));
+}
+
+// z_{n+1} = z_n^2 + c in high precision; Z_0 = 0 up to the first escaped Z_n
+// (included) or Z_maxIter
+inline std::vector<std::complex<double>> referenceOrbit(const Fixed& cr, const Fixed& ci, int maxIter) {
+    std::vector<std::complex<double>> orbit{{0.0, 0.0}};
+    Fixed zr(cr.limbs()), zi(cr.limbs());
+    for (int n = 0; n < maxIter; ++n) {
+        Fixed rr = zr * zr, ii = zi * zi, ri = zr * zi;
+        zr = rr - ii + cr;
+        zi = ri + ri + ci;
+        orbit.emplace_back(zr.toDouble(), zi.toDouble());
+        if (std::norm(orbit.back()) > 4.0) break;
+    }
+    return orbit;
+}
+
+// Escape count of c by high-precision iteration alone, for checking
+inline int directCount(const Fixed& cr, const Fixed& ci, int maxIter) {
+    return static_cast<int>(referenceOrbit(cr, ci, maxIter).size()) - 1;
+}
+
+struct DeepStats {
+    int referenceLength = 0;  // stored reference iterations
+    int skipped = 0;          // iterations every pixel skipped by the series
+    long long rebases = 0;    // glitch and end-of-reference rebases over all pixels
+};
+
+namespace deep_detail {
+
+// dz_skip = a dc + b dc^2 + c dc^3
+struct Series {
+    int skip = 0;
+    std::complex<double> a, b, c;
+
+    std::complex<double> at(std::complex<double> dc) const {
+        return skip ? ((c * dc + b) * dc + a) * dc : std::complex<double>();
+    }
+};
+
+// What the pixel loops need: the reference orbit as doubles (last = index of
+// its final entry), the series and the limit
+struct Orbit {
+    const double* re;
+    const double* im;
+    int last, maxIter;
+    Series series;
+};
+
+// One pixel, as described at the top
+inline int countScalar(const Orbit& o, std::complex<double> dc, long long& rebases) {
+    const double dcr = dc.real(), dci = dc.imag();
+    std::complex<double> dz = o.series.at(dc);
+    double zr = dz.real(), zi = dz.imag();  // dz
+    int m = o.series.skip;                  // reference iteration dz is relative to
+    for (int n = o.series.skip; n < o.maxIter; ++n) {
+        // dz = (2 Z + dz) dz + dc
+        double tr = 2.0 * o.re[m] + zr, ti = 2.0 * o.im[m] + zi;
+        double nr = tr * zr - ti * zi + dcr, ni = tr * zi + ti * zr + dci;
+        zr = nr, zi = ni;
+        ++m;
+        double fr = o.re[m] + zr, fi = o.im[m] + zi;  // the full z
+        double full = fr * fr + fi * fi;
+        if (full > 4.0) return n + 1;
+        if (full < zr * zr + zi * zi || m == o.last) {
+            zr = fr, zi = fi;
+            m = 0;
+            ++rebases;
+        }
+    }
+    return o.maxIter;
+}
+
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+// countScalar() on W lanes. Lanes are not kept in lockstep: each is at its own
+// reference index and iteration, and a lane whose pixel finished takes the next
+// one, so the lanes stay busy however much the counts differ. The vector step
+// runs until some lane needs attention (escape, rebase, iteration limit or end
+// of the reference), which is rare; the lanes are then sorted out one by one.
+template <int W>
+__attribute__((always_inline)) inline void countLanes(const Orbit& o, const double* dcr, const double* dci,
+                                                      int* counts, int pixels, long long& rebases) {
+    typedef typename simd_detail::Lanes<W>::D D;
+    double zr[W], zi[W], cr[W], ci[W], baseR[W], baseI[W], fr[W], fi[W], full[W], dzz[W];
+    int pixel[W], m[W], iter[W];
+    int next = 0, busy = 0;
+
+    auto load = [&](int l) {
+        if (next < pixels) {
+            std::complex<double> dz = o.series.at({dcr[next], dci[next]});
+            pixel[l] = next, cr[l] = dcr[next], ci[l] = dci[next], ++next, ++busy;
+            zr[l] = dz.real(), zi[l] = dz.imag();
+            m[l] = iter[l] = o.series.skip;
+        } else {
+            // Idle: dz and dc 0 keep it on the reference, harmlessly
+            pixel[l] = -1, cr[l] = ci[l] = zr[l] = zi[l] = 0.0;
+            m[l] = 0, iter[l] = o.maxIter;
+        }
+        baseR[l] = o.re[m[l]], baseI[l] = o.im[m[l]];
+    };
+    for (int l = 0; l < W; ++l) load(l);
+
+    while (busy > 0) {
+        int steps = o.maxIter;
+        for (int l = 0; l < W; ++l) {
+            if (pixel[l] >= 0) steps = std::min(steps, o.maxIter - iter[l]);
+        }
+        D vzr, vzi, vcr, vci, vbr, vbi;
+        std::memcpy(&vzr, zr, sizeof(D)), std::memcpy(&vzi, zi, sizeof(D));
+        std::memcpy(&vcr, cr, sizeof(D)), std::memcpy(&vci, ci, sizeof(D));
+        std::memcpy(&vbr, baseR, sizeof(D)), std::memcpy(&vbi, baseI, sizeof(D));
+        D vfr, vfi, vfull, vdzz;
+        int done = 0;
+        while (done < steps) {
+            D tr = 2.0 * vbr + vzr, ti = 2.0 * vbi + vzi;
+            D nr = tr * vzr - ti * vzi + vcr, ni = tr * vzi + ti * vzr + vci;
+            vzr = nr, vzi = ni;
+            bool end = false;
+            for (int l = 0; l < W; ++l) {
+                ++m[l];
+                vbr[l] = o.re[m[l]], vbi[l] = o.im[m[l]];
+                end |= m[l] == o.last;
+            }
+            vfr = vbr + vzr, vfi = vbi + vzi;
+            vfull = vfr * vfr + vfi * vfi;
+            vdzz = vzr * vzr + vzi * vzi;
+            ++done;
+            // Escape (|z|^2 > 4) or glitch (|z| < |dz|) as one comparison
+            D over = vfull - 4.0, under = vdzz - vfull;
+            D worst = over > under ? over : under;
+            typename simd_detail::Lanes<W>::I hit = worst > 0.0;
+            long long any = 0;
+            for (int l = 0; l < W; ++l) any |= hit[l];
+            if (any || end) break;
+        }
+        std::memcpy(zr, &vzr, sizeof(D)), std::memcpy(zi, &vzi, sizeof(D));
+        std::memcpy(baseR, &vbr, sizeof(D)), std::memcpy(baseI, &vbi, sizeof(D));
+        std::memcpy(fr, &vfr, sizeof(D)), std::memcpy(fi, &vfi, sizeof(D));
+        std::memcpy(full, &vfull, sizeof(D)), std::memcpy(dzz, &vdzz, sizeof(D));
+
+        for (int l = 0; l < W; ++l) {
+            iter[l] += done;
+            if (pixel[l] < 0) {
+                if (m[l] == o.last) m[l] = 0, baseR[l] = baseI[l] = 0.0;
+            } else if (full[l] > 4.0 || iter[l] == o.maxIter) {
+                counts[pixel[l]] = full[l] > 4.0 ? iter[l] : o.maxIter;
+                --busy;
+                load(l);
+            } else if (full[l] < dzz[l] || m[l] == o.last) {
+                zr[l] = fr[l], zi[l] = fi[l];
+                m[l] = 0, baseR[l] = o.re[0], baseI[l] = o.im[0];
+                ++rebases;
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2"))) inline void countAvx2(const Orbit& o, const double* dcr, const double* dci,
+                                                      int* counts, int pixels, long long& rebases) {
+    countLanes<4>(o, dcr, dci, counts, pixels, rebases);
+}
+
+__attribute__((target("avx512f"))) inline void countAvx512(const Orbit& o, const double* dcr, const double* dci,
+                                                           int* counts, int pixels, long long& rebases) {
+    countLanes<8>(o, dcr, dci, counts, pixels, rebases);
+}
+
+#pragma GCC pop_options
+
+}  // namespace deep_detail
+
+// Renders width x height pixels of 1 / pixelsPerUnit around (centerRe, centerIm),
+// given as decimal strings; image[y][x] is the point centre + ((x - width / 2),
+// (y - height / 2)) / pixelsPerUnit. The pixel loop uses the SIMD instruction
+// set 'isa' (mandelbrot_simd.h).
+class PerturbationRenderer {
+public:
+    PerturbationRenderer(const std::string& centerRe, const std::string& centerIm, double pixelsPerUnit, int maxIter,
+                         bool series = true)
+        : limbs_(limbsFor(pixelsPerUnit)),
+          cr_(Fixed::parse(centerRe, limbs_)),
+          ci_(Fixed::parse(centerIm, limbs_)),
+          pixelsPerUnit_(pixelsPerUnit),
+          maxIter_(maxIter),
+          series_(series) {
+        if (!(pixelsPerUnit > 0.0) || pixelsPerUnit > 1e290) {
+            throw std::invalid_argument("PerturbationRenderer: pixels per unit must be in (0, 1e290]");
+        }
+        for (auto z : referenceOrbit(cr_, ci_, maxIter_)) re_.push_back(z.real()), im_.push_back(z.imag());
+    }
+
+    int maxIter() const { return maxIter_; }
+
+    // Offset of pixel (x, y) from the centre
+    std::complex<double> offset(int x, int y, int width, int height) const {
+        return {(x - width / 2) / pixelsPerUnit_, (y - height / 2) / pixelsPerUnit_};
+    }
+
+    // The point of pixel (x, y) in full precision
+    std::pair<Fixed, Fixed> point(int x, int y, int width, int height) const {
+        std::complex<double> dc = offset(x, y, width, height);
+        return {cr_ + Fixed::fromDouble(dc.real(), limbs_), ci_ + Fixed::fromDouble(dc.imag(), limbs_)};
+    }
+
+    DeepStats render(Image& image, int threads, SimdIsa isa = detectIsa()) const {
+        using namespace deep_detail;
+        const int width = image.width(), height = image.height();
+        // The farthest pixel from the centre bounds the series error
+        Orbit orbit{re_.data(), im_.data(), static_cast<int>(re_.size()) - 1, maxIter_,
+                    series_ ? seriesFor(std::abs(offset(0, 0, width, height))) : Series{}};
+        DeepStats stats;
+        stats.referenceLength = orbit.last;
+        stats.skipped = orbit.series.skip;
+
+        const int rowsPerTask = 4;
+        std::vector<long long> rebases((height + rowsPerTask - 1) / rowsPerTask, 0);
+        runDynamic(static_cast<int>(rebases.size()), threads, [&](int task) {
+            int y0 = task * rowsPerTask, y1 = std::min(height, y0 + rowsPerTask);
+            std::vector<double> dcr, dci;
+            for (int y = y0; y < y1; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    std::complex<double> dc = offset(x, y, width, height);
+                    dcr.push_back(dc.real()), dci.push_back(dc.imag());
+                }
+            }
+            int* counts = image[y0];  // rows y0 .. y1 are contiguous
+            int pixels = static_cast<int>(dcr.size());
+            if (isa == SimdIsa::Avx512) countAvx512(orbit, dcr.data(), dci.data(), counts, pixels, rebases[task]);
+            else if (isa == SimdIsa::Avx2) countAvx2(orbit, dcr.data(), dci.data(), counts, pixels, rebases[task]);
+            else {
+                for (int i = 0; i < pixels; ++i) counts[i] = countScalar(orbit, {dcr[i], dci[i]}, rebases[task]);
+            }
+        });
+        for (long long r : rebases) stats.rebases += r;
+        return stats;
+    }
+
+private:
+    int limbs_;
+    Fixed cr_, ci_;
+    double pixelsPerUnit_;
+    int maxIter_;
+    bool series_;
+    std::vector<double> re_, im_;  // the reference orbit
+
+    // Iterates the coefficients along the reference for offsets up to 'radius':
+    //   A' = 2 Z A + 1,  B' = 2 Z B + A^2,  C' = 2 Z C + 2 A B
+    // and stops before the cubic term reaches 2^-40 of the linear one, or the
+    // bound on |z| could pass 2
+    deep_detail::Series seriesFor(double radius) const {
+        deep_detail::Series s;
+        std::complex<double> a, b, c;
+        const int last = static_cast<int>(re_.size()) - 1;
+        for (int n = 0; n < last; ++n) {
+            std::complex<double> z2(2.0 * re_[n], 2.0 * im_[n]);
+            std::complex<double> na = z2 * a + 1.0, nb = z2 * b + a * a, nc = z2 * c + 2.0 * a * b;
+            double linear = std::abs(na) * radius, cubic = std::abs(nc) * radius * radius * radius;
+            double bound = std::hypot(re_[n + 1], im_[n + 1]) + linear + std::abs(nb) * radius * radius + cubic;
+            if (!std::isfinite(bound) || cubic > std::ldexp(linear, -40) || bound > 2.0) break;
+            a = na, b = nb, c = nc;
+            s = {n + 1, a, b, c};
+        }
+        return s;
+    }
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include "mandelbrot_schedule.h"
+
+// Image storage and output for the Mandelbrot renderers.
+//
+// Image keeps the counts in one flat row-major buffer (image[y][x] still works)
+// instead of a heap allocation per row. ImageWriter writes rows in order, a band
+// at a time, in one of four formats:
+//   Csv  the comma-separated counts, one line per row; each band is formatted
+//        with std::to_chars on all threads, then written in one go
+//   Raw  the counts as little-endian 32-bit integers, no header
+//   Pgm  binary greyscale (P5) with maxval the largest count (scaled down to
+//        65535 when larger): 1-byte samples when maxval < 256, else 2 bytes
+//   Png  16-bit greyscale, counts scaled to 0 .. 65535; the zlib stream uses
+//        stored (uncompressed) deflate blocks, one IDAT chunk per band, so no
+//        compression library is needed and bands can be written as they come
+// BandStreamer runs an ImageWriter on its own thread while the image is still
+// being computed: workers report finished tiles, and each band of rows is
+// written as soon as all of its tiles are done.
+
+class Image {
+public:
+    Image(int width = 0, int height = 0) : width_(width), height_(height), counts_(size_t(width) * height) {}
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int* operator[](int y) { return counts_.data() + size_t(y) * width_; }
+    const int* operator[](int y) const { return counts_.data() + size_t(y) * width_; }
+    void clear() { std::fill(counts_.begin(), counts_.end(), 0); }
+    bool operator==(const Image& other) const {
+        return width_ == other.width_ && height_ == other.height_ && counts_ == other.counts_;
+    }
+
+private:
+    int width_, height_;
+    std::vector<int> counts_;
+};
+
+enum class ImageFormat { Csv, Raw, Pgm, Png };
+
+// Format of a file name by its extension; CSV for anything unknown
+inline ImageFormat formatOf(const std::string& path) {
+    auto ends = [&](const char* ext) {
+        std::string e = ext;
+        return path.size() >= e.size() && path.compare(path.size() - e.size(), e.size(), e) == 0;
+    };
+    if (ends(".raw")) return ImageFormat::Raw;
+    if (ends(".pgm")) return ImageFormat::Pgm;
+    if (ends(".png")) return ImageFormat::Png;
+    return ImageFormat::Csv;
+}
+
+// Rows [0, rows) of width counts as CSV lines, formatted in blocks of rows on
+// 'threads' threads and joined in order
+inline std::string formatCsv(const int* counts, int width, int rows, int threads) {
+    const int rowsPerBlock = 8;
+    const int blocks = (rows + rowsPerBlock - 1) / rowsPerBlock;
+    std::vector<std::string> text(blocks);
+    runDynamic(blocks, std::min(threads, blocks), [&](int b) {
+        int y0 = b * rowsPerBlock, y1 = std::min(y0 + rowsPerBlock, rows);
+        std::string& out = text[b];
+        out.resize(size_t(y1 - y0) * width * 12);  // at most 11 characters and a separator per count
+        char* at = out.data();
+        for (int y = y0; y < y1; ++y) {
+            const int* row = counts + size_t(y) * width;
+            for (int x = 0; x < width; ++x) {
+                at = std::to_chars(at, out.data() + out.size(), row[x]).ptr;
+                *at++ = x + 1 == width ? '\n' : ',';
+            }
+        }
+        out.resize(at - out.data());
+    });
+    std::string joined;
+    size_t total = 0;
+    for (const auto& t : text) total += t.size();
+    joined.reserve(total);
+    for (const auto& t : text) joined += t;
+    return joined;
+}
+
+class ImageWriter {
+public:
+    // maxValue is the largest count (MAX_ITER), used by PGM and PNG
+    ImageWriter(const std::string& path, ImageFormat format, int width, int height, int maxValue,
+                int threads = workerThreads())
+        : out_(path, std::ios::binary), format_(format), width_(width), height_(height), maxValue_(maxValue),
+          threads_(threads) {
+        if (!out_) throw std::runtime_error("cannot open " + path);
+        if (maxValue < 1) throw std::invalid_argument("ImageWriter: maxValue must be positive");
+        if (format_ == ImageFormat::Pgm) {
+            std::string header = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n" +
+                                 std::to_string(std::min(maxValue, 65535)) + "\n";
+            out_.write(header.data(), header.size());
+        } else if (format_ == ImageFormat::Png) {
+            static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+            out_.write(reinterpret_cast<const char*>(signature), 8);
+            std::string ihdr;
+            put32(ihdr, width);
+            put32(ihdr, height);
+            ihdr += {16, 0, 0, 0, 0};  // 16-bit greyscale, deflate, no filter, no interlace
+            chunk("IHDR", ihdr);
+            pending_ = {0x78, 0x01};  // zlib header: deflate, 32K window, no dictionary
+        }
+    }
+
+    // Writes the next 'rows' rows, stored one after the other from 'counts'
+    void writeRows(const int* counts, int rows) {
+        if (written_ + rows > height_) throw std::logic_error("ImageWriter: more rows than the image has");
+        written_ += rows;
+        switch (format_) {
+            case ImageFormat::Csv: {
+                std::string text = formatCsv(counts, width_, rows, threads_);
+                out_.write(text.data(), text.size());
+                break;
+            }
+            case ImageFormat::Raw: {
+                std::string bytes;
+                bytes.reserve(size_t(rows) * width_ * 4);
+                for (size_t i = 0; i < size_t(rows) * width_; ++i) {
+                    uint32_t v = counts[i];
+                    bytes += {char(v), char(v >> 8), char(v >> 16), char(v >> 24)};
+                }
+                out_.write(bytes.data(), bytes.size());
+                break;
+            }
+            case ImageFormat::Pgm: {
+                std::string bytes;
+                bytes.reserve(size_t(rows) * width_ * 2);
+                for (size_t i = 0; i < size_t(rows) * width_; ++i) {
+                    uint32_t v = maxValue_ > 65535 ? scaled(counts[i]) : counts[i];
+                    if (maxValue_ < 256) bytes += char(v);  // the format wants one byte then
+                    else bytes += {char(v >> 8), char(v)};
+                }
+                out_.write(bytes.data(), bytes.size());
+                break;
+            }
+            case ImageFormat::Png: {
+                // Each scanline: filter type 0 (none), then big-endian samples
+                std::string raw;
+                raw.reserve(size_t(rows) * (1 + 2 * width_));
+                for (int y = 0; y < rows; ++y) {
+                    raw += char(0);
+                    for (int x = 0; x < width_; ++x) {
+                        uint32_t v = scaled(counts[size_t(y) * width_ + x]);
+                        raw += {char(v >> 8), char(v)};
+                    }
+                }
+                adler_.update(raw);
+                storedBlocks(raw, false);
+                chunk("IDAT", pending_);
+                pending_.clear();
+                break;
+            }
+        }
+        if (!out_) throw std::runtime_error("ImageWriter: write failed");
+    }
+
+    // Ends the file; every row must have been written
+    void finish() {
+        if (written_ != height_) throw std::logic_error("ImageWriter: image incomplete");
+        if (format_ == ImageFormat::Png) {
+            storedBlocks("", true);  // empty final block
+            put32(pending_, adler_.value());
+            chunk("IDAT", pending_);
+            chunk("IEND", "");
+        }
+        out_.close();
+        if (!out_) throw std::runtime_error("ImageWriter: write failed");
+    }
+
+private:
+    std::ofstream out_;
+    ImageFormat format_;
+    int width_, height_, maxValue_, threads_;
+    int written_ = 0;
+    std::string pending_;  // zlib bytes not yet in an IDAT chunk
+
+    struct Adler32 {
+        uint32_t a = 1, b = 0;
+        void update(const std::string& data) {
+            // 5552 bytes is the most that cannot overflow b before the reduction
+            for (size_t i = 0; i < data.size(); i += 5552) {
+                size_t end = std::min(data.size(), i + 5552);
+                for (size_t j = i; j < end; ++j) a += static_cast<unsigned char>(data[j]), b += a;
+                a %= 65521, b %= 65521;
+            }
+        }
+        uint32_t value() const { return b << 16 | a; }
+    } adler_;
+
+    // count * 65535 / maxValue, rounded
+    uint32_t scaled(int count) const { return (uint64_t(count) * 65535u + maxValue_ / 2) / maxValue_; }
+
+    static void put32(std::string& s, uint32_t v) { s += {char(v >> 24), char(v >> 16), char(v >> 8), char(v)}; }
+
+    static uint32_t crc32(const std::string& data, uint32_t crc = 0) {
+        static const std::vector<uint32_t> table = [] {
+            std::vector<uint32_t> t(256);
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+        crc = ~crc;
+        for (unsigned char byte : data) crc = table[(crc ^ byte) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    // Appends 'data' to pending_ as stored deflate blocks of at most 65535 bytes
+    void storedBlocks(const std::string& data, bool final) {
+        size_t at = 0;
+        do {
+            size_t len = std::min<size_t>(65535, data.size() - at);
+            bool last = final && at + len == data.size();
+            pending_ += {char(last ? 1 : 0), char(len), char(len >> 8), char(~len), char(~len >> 8)};
+            pending_.append(data, at, len);
+            at += len;
+        } while (at < data.size());
+    }
+
+    void chunk(const char* type, const std::string& data) {
+        std::string head, body = std::string(type) + data;
+        put32(head, data.size());
+        std::string tail;
+        put32(tail, crc32(body));
+        out_.write(head.data(), head.size());
+        out_.write(body.data(), body.size());
+        out_.write(tail.data(), tail.size());
+    }
+};
+
+// Writes an image with 'writer' band by band while it is being computed. The
+// image is split into bands of bandHeight rows, each made of tilesPerBand
+// tiles; a worker calls tileDone(band) when it has finished a tile, and the
+// writer thread writes every band, in order, once all its tiles are in.
+class BandStreamer {
+public:
+    BandStreamer(ImageWriter& writer, const Image& image, int bandHeight, int tilesPerBand)
+        : writer_(writer), image_(image), bandHeight_(bandHeight), tilesPerBand_(tilesPerBand),
+          done_((image.height() + bandHeight - 1) / bandHeight, 0) {
+        thread_ = std::thread([this] { run(); });
+    }
+    ~BandStreamer() {
+        if (thread_.joinable()) thread_.join();
+    }
+
+    void tileDone(int band) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (++done_[band] == tilesPerBand_) ready_.notify_one();
+    }
+
+    // Waits until every band is written; rethrows a write error
+    void finish() {
+        thread_.join();
+        if (error_) std::rethrow_exception(error_);
+    }
+
+private:
+    ImageWriter& writer_;
+    const Image& image_;
+    int bandHeight_, tilesPerBand_;
+    std::vector<int> done_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::thread thread_;
+    std::exception_ptr error_;
+
+    void run() {
+        try {
+            for (size_t band = 0; band < done_.size(); ++band) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_.wait(lock, [&] { return done_[band] == tilesPerBand_; });
+                }
+                int y0 = band * bandHeight_, y1 = std::min<int>(y0 + bandHeight_, image_.height());
+                writer_.writeRows(image_[y0], y1 - y0);
+            }
+            writer_.finish();
+        } catch (...) {
+            error_ = std::current_exception();
+        }
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <unordered_map>
+#include <algorithm>
+#include "mandelbrot_simd.h"
+#include "mandelbrot_schedule.h"
+#include "mandelbrot_image.h"
+
+// Progressive Mandelbrot rendering with a cache of computed samples, for
+// sequences of overlapping views (panning, zooming).
+//
+// Every view at a resolution of p pixels per unit samples the same lattice:
+// pixel (px, py) is the point (i / p, j / p) for integers i = originX() + px,
+// j = originY() + py, the centre being snapped to the nearest lattice point. The
+// lattice is cut into TileCache::TILE x TILE tiles, cached under (tile index,
+// resolution, max_iter), so a view that overlaps an earlier one at the same
+// resolution finds those pixels already computed.
+//
+// A frame is rendered in passes of step 8, 4, 2, 1 (by default): a pass computes
+// the lattice points whose i and j are multiples of the step, unless the cache
+// has them, and shows each as a step x step block; the next pass only adds the
+// points in between. The last pass is the exact image.
+//
+// Zooming in by 2 doubles p, and point (i, j) at p / 2 is point (2i, 2j) at p,
+// the very same double coordinates (only the exponent differs), so those
+// samples are taken from the tiles of the coarser resolution.
+//
+// The samples are escape counts from escapeCounts() with the interior checks,
+// the same counts the plain loop gives for those points.
+
+struct Viewport {
+    double centerX, centerY;  // snapped to the lattice
+    double pixelsPerUnit;
+    int width, height, maxIter;
+
+    long long originX() const { return std::llround(centerX * pixelsPerUnit) - width / 2; }
+    long long originY() const { return std::llround(centerY * pixelsPerUnit) - height / 2; }
+};
+
+class TileCache {
+public:
+    static const int TILE = 64;  // lattice points per tile side; a multiple of every pass step
+
+    struct Key {
+        uint64_t resolution;  // bits of pixelsPerUnit
+        int maxIter;
+        long long tileX, tileY;
+        bool operator==(const Key& o) const {
+            return resolution == o.resolution && maxIter == o.maxIter && tileX == o.tileX && tileY == o.tileY;
+        }
+    };
+
+    // TILE x TILE counts, row by row; -1 where not computed yet
+    struct Tile {
+        std::vector<int> counts = std::vector<int>(TILE * TILE, -1);
+    };
+
+    static Key keyOf(double pixelsPerUnit, int maxIter, long long tileX, long long tileY) {
+        uint64_t bits;
+        std::memcpy(&bits, &pixelsPerUnit, sizeof bits);
+        return {bits, maxIter, tileX, tileY};
+    }
+
+    // Keeps at most 'capacity' tiles (the default is 64 MB of counts), dropping
+    // the least recently used
+    explicit TileCache(size_t capacity = 4096) : capacity_(capacity) {}
+
+    // The tile, made empty if 'create' and not cached, otherwise null if not cached
+    std::shared_ptr<Tile> get(const Key& key, bool create) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = tiles_.find(key);
+        if (it != tiles_.end()) {
+            order_.splice(order_.begin(), order_, it->second.second);
+            return it->second.first;
+        }
+        if (!create) return nullptr;
+        if (tiles_.size() >= capacity_) {
+            tiles_.erase(order_.back());
+            order_.pop_back();
+        }
+        order_.push_front(key);
+        auto tile = std::make_shared<Tile>();
+        tiles_.emplace(key, std::make_pair(tile, order_.begin()));
+        return tile;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tiles_.size();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tiles_.clear();
+        order_.clear();
+    }
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = k.resolution ^ (uint64_t(k.maxIter) << 32);
+            h = h * 0x9E3779B97F4A7C15ull ^ uint64_t(k.tileX);
+            h = h * 0x9E3779B97F4A7C15ull ^ uint64_t(k.tileY);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Key> order_;  // most recently used first
+    std::unordered_map<Key, std::pair<std::shared_ptr<Tile>, std::list<Key>::iterator>, KeyHash> tiles_;
+};
+
+struct FrameStats {
+    long long computed = 0;     // lattice points iterated, a few outside the view in coarse passes
+    long long fromCoarser = 0;  // points copied from the half resolution
+    double firstPassSeconds = 0.0, seconds = 0.0;
+};
+
+class ProgressiveRenderer {
+public:
+    ProgressiveRenderer(TileCache& cache, SimdIsa isa = detectIsa(), int threads = workerThreads())
+        : cache_(cache), isa_(isa), threads_(threads) {}
+
+    // Renders 'view' into 'image' (view.width x view.height) in 'passes' passes,
+    // the first of step 2^(passes - 1) (at most TILE); onPass(image, step) sees
+    // each one
+    template <typename OnPass>
+    FrameStats render(const Viewport& view, Image& image, int passes, OnPass onPass) {
+        passes = std::clamp(passes, 1, 7);
+        auto start = std::chrono::steady_clock::now();
+        const long long x0 = view.originX(), y0 = view.originY();
+        const long long tx0 = floorDiv(x0, TILE), ty0 = floorDiv(y0, TILE);
+        const int tilesX = static_cast<int>(floorDiv(x0 + view.width - 1, TILE) - tx0 + 1);
+        const int tilesY = static_cast<int>(floorDiv(y0 + view.height - 1, TILE) - ty0 + 1);
+        std::vector<long long> computed(tilesX * tilesY, 0), fromCoarser(tilesX * tilesY, 0);
+
+        FrameStats stats;
+        for (int pass = passes - 1; pass >= 0; --pass) {
+            const int step = 1 << pass;
+            runDynamic(tilesX * tilesY, threads_, [&](int t) {
+                long long tx = tx0 + t % tilesX, ty = ty0 + t / tilesX;
+                fillTile(view, image, tx, ty, step, computed[t], fromCoarser[t]);
+            });
+            if (pass == passes - 1) {
+                stats.firstPassSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            onPass(static_cast<const Image&>(image), step);
+        }
+        for (size_t t = 0; t < computed.size(); ++t) stats.computed += computed[t], stats.fromCoarser += fromCoarser[t];
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    FrameStats render(const Viewport& view, Image& image, int passes = 4) {
+        return render(view, image, passes, [](const Image&, int) {});
+    }
+
+private:
+    static const int TILE = TileCache::TILE;
+    TileCache& cache_;
+    SimdIsa isa_;
+    int threads_;
+
+    static long long floorDiv(long long a, long long b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+    // One pass over lattice tile (tx, ty): computes its missing points of this
+    // step from the top left pixel's block (which may lie left of or above the
+    // view) to the view's far edge, then paints its part of the image
+    void fillTile(const Viewport& view, Image& image, long long tx, long long ty, int step, long long& computed,
+                  long long& fromCoarser) {
+        const long long x0 = view.originX(), y0 = view.originY();
+        auto tile = cache_.get(TileCache::keyOf(view.pixelsPerUnit, view.maxIter, tx, ty), true);
+        // Lattice range of this tile that the view needs at this step (the
+        // tile starts at a multiple of the step)
+        const long long block = ~static_cast<long long>(step - 1);  // i & block rounds down to a multiple of step
+        long long ix0 = std::max(tx * TILE, x0 & block), ix1 = std::min((tx + 1) * TILE, x0 + view.width);
+        long long iy0 = std::max(ty * TILE, y0 & block), iy1 = std::min((ty + 1) * TILE, y0 + view.height);
+
+        Coarser coarser{view, nullptr, 0, 0, false};
+        std::vector<double> cx, cy;
+        std::vector<int> where, counts;
+        cx.reserve(TILE * TILE), cy.reserve(TILE * TILE), where.reserve(TILE * TILE);
+        double xs[TILE];  // real parts of the tile's columns
+        for (long long i = ix0; i < ix1; i += step) xs[i - tx * TILE] = static_cast<double>(i) / view.pixelsPerUnit;
+        for (long long j = iy0; j < iy1; j += step) {
+            const double y = static_cast<double>(j) / view.pixelsPerUnit;
+            for (long long i = ix0; i < ix1; i += step) {
+                int k = static_cast<int>((j - ty * TILE) * TILE + (i - tx * TILE));
+                if (tile->counts[k] >= 0) continue;
+                if (i % 2 == 0 && j % 2 == 0 && (tile->counts[k] = coarser.count(cache_, i / 2, j / 2)) >= 0) {
+                    ++fromCoarser;
+                    continue;
+                }
+                cx.push_back(xs[i - tx * TILE]);
+                cy.push_back(y);
+                where.push_back(k);
+            }
+        }
+        if (!where.empty()) {
+            counts.resize(where.size());
+            escapeCounts(cx.data(), cy.data(), counts.data(), where.size(), view.maxIter, isa_, wideLanes(isa_), true);
+            for (size_t n = 0; n < where.size(); ++n) tile->counts[where[n]] = counts[n];
+            computed += where.size();
+        }
+
+        // Each pixel shows the sample at the top left corner of its block
+        long long px0 = std::max(tx * TILE, x0), px1 = std::min((tx + 1) * TILE, x0 + view.width);
+        long long py0 = std::max(ty * TILE, y0), py1 = std::min((ty + 1) * TILE, y0 + view.height);
+        for (long long j = py0; j < py1; ++j) {
+            const int* samples = tile->counts.data() + ((j & block) - ty * TILE) * TILE - tx * TILE;
+            int* row = image[j - y0] - x0;
+            for (long long i = px0; i < px1; ++i) row[i] = samples[i & block];
+        }
+    }
+
+    // Lattice points (i, j) at half the resolution, remembering the last tile
+    // looked up since neighbouring points share it
+    struct Coarser {
+        const Viewport& view;
+        std::shared_ptr<TileCache::Tile> tile;
+        long long tx, ty;
+        bool looked;
+
+        // The count, or -1 if not cached
+        int count(TileCache& cache, long long i, long long j) {
+            long long x = floorDiv(i, TILE), y = floorDiv(j, TILE);
+            if (!looked || x != tx || y != ty) {
+                tile = cache.get(TileCache::keyOf(view.pixelsPerUnit / 2, view.maxIter, x, y), false);
+                tx = x, ty = y, looked = true;
+            }
+            return tile ? tile->counts[(j - y * TILE) * TILE + (i - x * TILE)] : -1;
+        }
+    };
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+
+// Work distribution for the Mandelbrot renderers.
+//
+// The cost of a tile varies by orders of magnitude (points inside the set run
+// to MAX_ITER, points far outside escape at once), so handing each thread a
+// fixed block leaves a few threads with most of the work. runDynamic() keeps
+// one shared atomic counter instead: every thread takes the next task index
+// when it is done with its current one, so the threads finish within about one
+// task of each other. runStatic() is the old fixed split, for comparison.
+//
+// Both record how long each thread spent in tasks (busy time) and how many it
+// did, which is what shows the balance.
+
+struct ThreadStats {
+    double busySeconds = 0.0;
+    int tasks = 0;
+};
+
+// MANDELBROT_THREADS if set, otherwise the number of hardware threads
+inline int workerThreads() {
+    if (const char* env = std::getenv("MANDELBROT_THREADS")) {
+        int n = std::atoi(env);
+        if (n > 0) return n;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+namespace schedule_detail {
+
+// Runs body(t, stats[t]) on 'threads' threads and waits for them
+template <typename Body>
+std::vector<ThreadStats> runThreads(int threads, Body body) {
+    std::vector<ThreadStats> stats(threads);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back([&, t] { body(t, stats[t]); });
+    for (auto& th : pool) th.join();
+    return stats;
+}
+
+template <typename Work>
+void timed(Work& work, int task, ThreadStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    work(task);
+    stats.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ++stats.tasks;
+}
+
+}  // namespace schedule_detail
+
+// work(i) for i in [0, tasks), each index taken from a shared counter
+template <typename Work>
+std::vector<ThreadStats> runDynamic(int tasks, int threads, Work work) {
+    std::atomic<int> next{0};
+    return schedule_detail::runThreads(threads, [&](int, ThreadStats& stats) {
+        for (int i = next.fetch_add(1, std::memory_order_relaxed); i < tasks;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            schedule_detail::timed(work, i, stats);
+        }
+    });
+}
+
+// work(i) for i in [0, tasks), thread t doing the t-th contiguous block
+template <typename Work>
+std::vector<ThreadStats> runStatic(int tasks, int threads, Work work) {
+    return schedule_detail::runThreads(threads, [&](int t, ThreadStats& stats) {
+        int per = tasks / threads;
+        int start = t * per, end = t == threads - 1 ? tasks : start + per;
+        for (int i = start; i < end; ++i) schedule_detail::timed(work, i, stats);
+    });
+}
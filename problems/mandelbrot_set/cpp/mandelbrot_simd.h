@@ -0,0 +1,270 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <string>
+
+// SIMD Mandelbrot kernel: W pixels per call of the escape loop, one per lane.
+//
+// Every lane runs exactly the scalar recurrence of mandelbrot() in
+// mandelbrot.cpp, z = z * z + c with std::complex rounding (re = (a a - b b) + x,
+// im = (a b + a b) + y) while |z|^2 <= 4, so the counts are the same bit for bit:
+//   - a lane that has escaped is masked: its z is frozen and its count stops
+//     (for |c| > 2 an escaped z could otherwise fall back inside the circle)
+//   - the loop exits as soon as every lane has escaped, or at maxIter
+//   - multiply-adds are not fused into FMAs here, which would round differently
+// W is 4 or 8 doubles with AVX2 and 8 or 16 with AVX-512, the wide ones as two
+// registers iterated side by side, which hides the latency of the dependent
+// multiplies at the cost of running until the slowest of more lanes escapes.
+// The kernel is written once with GCC vector extensions, compiled for each
+// instruction set, and picked at run time (or by MANDELBROT_ISA: scalar, avx2,
+// avx512).
+
+enum class SimdIsa { Scalar, Avx2, Avx512 };
+
+inline const char* isaName(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::Avx512: return "avx512";
+        case SimdIsa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+inline bool isaSupported(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::Avx512: return __builtin_cpu_supports("avx512f");
+        case SimdIsa::Avx2: return __builtin_cpu_supports("avx2");
+        default: return true;
+    }
+}
+
+// Best instruction set of this CPU, unless MANDELBROT_ISA asks for a (supported) other one
+inline SimdIsa detectIsa() {
+    if (const char* env = std::getenv("MANDELBROT_ISA")) {
+        std::string name = env;
+        for (SimdIsa isa : {SimdIsa::Scalar, SimdIsa::Avx2, SimdIsa::Avx512}) {
+            if (name == isaName(isa) && isaSupported(isa)) return isa;
+        }
+    }
+    if (isaSupported(SimdIsa::Avx512)) return SimdIsa::Avx512;
+    if (isaSupported(SimdIsa::Avx2)) return SimdIsa::Avx2;
+    return SimdIsa::Scalar;
+}
+
+// Lanes tried for an instruction set, narrow one first
+inline int narrowLanes(SimdIsa isa) { return isa == SimdIsa::Avx512 ? 8 : isa == SimdIsa::Avx2 ? 4 : 1; }
+inline int wideLanes(SimdIsa isa) { return 2 * narrowLanes(isa); }
+
+namespace simd_detail {
+
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+// W doubles and the W 64-bit lane masks their comparisons give
+template <int W>
+struct Lanes {
+    typedef double D __attribute__((vector_size(8 * W)));
+    typedef long I __attribute__((vector_size(8 * W)));  // what comparisons of D give
+};
+
+// Lane state: z, the escape count, and the z saved for cycle detection
+template <int W>
+struct State {
+    typename Lanes<W>::D zr, zi, savedR, savedI, x, y;
+    typename Lanes<W>::I count;
+};
+
+// Marks a lane known to be inside the set: its z is set to this value, whose
+// |z|^2 overflows past 4 so the lane stops like an escaped one, but no escaped
+// lane can hold it (those stop at the first z beyond radius 2, far below it).
+// Markers rather than a separate mask keep every lane condition a single
+// comparison, which AVX-512 keeps in mask registers (combining the masks of
+// several comparisons makes GCC fall back to scalar code).
+const double INSIDE = 1e300;
+
+// One step of the masked recurrence on W lanes; false once none is running
+template <int W, bool Interior>
+__attribute__((always_inline)) inline bool step(State<W>& s) {
+    typedef typename Lanes<W>::D D;
+    typedef typename Lanes<W>::I I;
+    D rr = s.zr * s.zr, ii = s.zi * s.zi;
+    I active = rr + ii <= 4.0;
+    D ri = s.zr * s.zi;
+    D nr = rr - ii + s.x, ni = ri + ri + s.y;
+    s.zr = active ? nr : s.zr;
+    s.zi = active ? ni : s.zi;
+    s.count -= active;
+    if (Interior) {
+        // Back to a saved z exactly: the orbit is periodic, so it never escapes
+        // (one <= rather than two ==, see INSIDE; a difference of saved and
+        // current z too small to square is taken as a match as well)
+        D dr = s.zr - s.savedR, di = s.zi - s.savedI;
+        s.zr = dr * dr + di * di <= 0.0 ? INSIDE : s.zr;
+    }
+    long long any = 0;
+    for (int l = 0; l < W; ++l) any |= active[l];
+    return any != 0;
+}
+
+// Main cardioid or period-2 bulb; both never escape. Written out again for the
+// vector lanes in escapeLanes (a helper returning a vector would change the ABI).
+inline bool knownInside(double x, double y) {
+    double xq = x - 0.25, yy = y * y;
+    double q = xq * xq + yy;
+    double x1 = x + 1.0;
+    return q * (q + xq) <= 0.25 * yy || x1 * x1 + yy <= 0.0625;
+}
+
+// R registers of W lanes each, iterated side by side. With Interior, lanes in
+// the cardioid or bulb start finished, and a lane whose z returns (exactly, up
+// to underflow) to the value saved at the last power-of-two step (Brent's cycle
+// detection) stops; both get maxIter, which is what the plain loop would reach.
+// Only z inside radius 2 is saved (NaN otherwise), so a lane frozen after
+// escaping never matches.
+template <int W, int R, bool Interior>
+__attribute__((always_inline)) inline void escapeLanes(const double* cx, const double* cy, int* iters, int maxIter) {
+    typedef typename Lanes<W>::D D;
+    typedef typename Lanes<W>::I I;
+    const double nan = __builtin_nan("");
+    State<W> s[R];
+    for (int r = 0; r < R; ++r) {
+        std::memcpy(&s[r].x, cx + r * W, sizeof(D));
+        std::memcpy(&s[r].y, cy + r * W, sizeof(D));
+        s[r].zr = s[r].zi = D{};
+        s[r].savedR = s[r].savedI = D{} + nan;
+        s[r].count = I{};
+        if (Interior) {
+            D xq = s[r].x - 0.25, yy = s[r].y * s[r].y;
+            D q = xq * xq + yy;
+            D x1 = s[r].x + 1.0;
+            s[r].zr = q * (q + xq) <= 0.25 * yy ? INSIDE : s[r].zr;
+            s[r].zr = x1 * x1 + yy <= 0.0625 ? INSIDE : s[r].zr;
+        }
+    }
+
+    int checkpoint = 1;
+    for (int it = 0; it < maxIter; ++it) {
+        bool any = false;
+        for (int r = 0; r < R; ++r) any |= step<W, Interior>(s[r]);
+        if (!any) break;
+        if (Interior && it + 1 == checkpoint) {
+            for (int r = 0; r < R; ++r) {
+                D inCircle = s[r].zr * s[r].zr + s[r].zi * s[r].zi <= 4.0 ? s[r].zr : nan;
+                s[r].savedR = inCircle;
+                s[r].savedI = s[r].zi;
+            }
+            checkpoint *= 2;
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int l = 0; l < W; ++l) {
+            iters[r * W + l] = Interior && s[r].zr[l] == INSIDE ? maxIter : static_cast<int>(s[r].count[l]);
+        }
+    }
+}
+
+template <bool Interior>
+inline void escapeScalar(const double* cx, const double* cy, int* iters, int maxIter) {
+    if (Interior && knownInside(*cx, *cy)) {
+        *iters = maxIter;
+        return;
+    }
+    double zr = 0.0, zi = 0.0, savedR = 0.0, savedI = 0.0;
+    int iter = 0, checkpoint = 1;
+    while (zr * zr + zi * zi <= 4.0 && iter < maxIter) {
+        double rr = zr * zr, ii = zi * zi, ri = zr * zi;
+        zr = rr - ii + *cx;
+        zi = ri + ri + *cy;
+        ++iter;
+        if (Interior) {
+            double dr = zr - savedR, di = zi - savedI;
+            if (dr * dr + di * di <= 0.0) {  // same test as step()
+                iter = maxIter;
+                break;
+            }
+            if (iter == checkpoint) savedR = zr, savedI = zi, checkpoint *= 2;
+        }
+    }
+    *iters = iter;
+}
+
+template <bool Interior>
+__attribute__((target("avx2"))) inline void escapeAvx2x4(const double* cx, const double* cy, int* iters, int maxIter) {
+    escapeLanes<4, 1, Interior>(cx, cy, iters, maxIter);
+}
+
+template <bool Interior>
+__attribute__((target("avx2"))) inline void escapeAvx2x8(const double* cx, const double* cy, int* iters, int maxIter) {
+    escapeLanes<4, 2, Interior>(cx, cy, iters, maxIter);
+}
+
+template <bool Interior>
+__attribute__((target("avx512f"))) inline void escapeAvx512x8(const double* cx, const double* cy, int* iters,
+                                                               int maxIter) {
+    escapeLanes<8, 1, Interior>(cx, cy, iters, maxIter);
+}
+
+template <bool Interior>
+__attribute__((target("avx512f"))) inline void escapeAvx512x16(const double* cx, const double* cy, int* iters,
+                                                                int maxIter) {
+    escapeLanes<8, 2, Interior>(cx, cy, iters, maxIter);
+}
+
+#pragma GCC pop_options
+
+}  // namespace simd_detail
+
+namespace simd_detail {
+
+typedef void (*Kernel)(const double*, const double*, int*, int);
+
+// The kernel for exactly 'lanes' lanes (1, narrowLanes(isa) or wideLanes(isa))
+inline Kernel pickKernel(SimdIsa isa, int lanes, bool interior) {
+    if (lanes == 1) return interior ? escapeScalar<true> : escapeScalar<false>;
+    if (isa == SimdIsa::Avx512 && lanes == 16) return interior ? escapeAvx512x16<true> : escapeAvx512x16<false>;
+    if (isa == SimdIsa::Avx512) return interior ? escapeAvx512x8<true> : escapeAvx512x8<false>;
+    if (lanes == 8) return interior ? escapeAvx2x8<true> : escapeAvx2x8<false>;
+    return interior ? escapeAvx2x4<true> : escapeAvx2x4<false>;
+}
+
+}  // namespace simd_detail
+
+// iters[i] = escape count of c = cx[i] + i cy[i], for count points, 'lanes'
+// at a time (1, narrowLanes(isa) or wideLanes(isa), anything else meaning the
+// narrow one). The points left over go through the narrow kernel, padded with
+// points that escape at once, or one by one when they would fill less than a
+// quarter of it: a group costs as much as its slowest lane, so short rows
+// (Mariani-Silver cut lines) would otherwise pay for a whole register each.
+// interior = true adds the cardioid/bulb tests and cycle detection, which only
+// shortcut points that would run to maxIter anyway.
+inline void escapeCounts(const double* cx, const double* cy, int* iters, size_t count, int maxIter, SimdIsa isa,
+                         int lanes, bool interior = false) {
+    using namespace simd_detail;
+    if (lanes <= 1 || isa == SimdIsa::Scalar) lanes = 1;
+    else lanes = lanes == wideLanes(isa) ? wideLanes(isa) : narrowLanes(isa);
+
+    size_t i = 0;
+    Kernel kernel = pickKernel(isa, lanes, interior);
+    for (; i + lanes <= count; i += lanes) kernel(cx + i, cy + i, iters + i, maxIter);
+    if (lanes > 1 && count - i >= static_cast<size_t>(narrowLanes(isa))) {
+        lanes = narrowLanes(isa);
+        kernel = pickKernel(isa, lanes, interior);
+        for (; i + lanes <= count; i += lanes) kernel(cx + i, cy + i, iters + i, maxIter);
+    }
+    lanes = narrowLanes(isa);
+    if (i < count && 4 * (count - i) >= static_cast<size_t>(lanes)) {
+        kernel = pickKernel(isa, lanes, interior);
+        double px[16], py[16];
+        int out[16];
+        for (int l = 0; l < lanes; ++l) {
+            px[l] = i + l < count ? cx[i + l] : 4.0;
+            py[l] = i + l < count ? cy[i + l] : 0.0;
+        }
+        kernel(px, py, out, maxIter);
+        for (size_t l = 0; i + l < count; ++l) iters[i + l] = out[l];
+        i = count;
+    }
+    kernel = pickKernel(isa, 1, interior);
+    for (; i < count; ++i) kernel(cx + i, cy + i, iters + i, maxIter);
+}